@@ -1,9 +1,14 @@
+#define _GNU_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include <unistd.h>
 #include <getopt.h>
 #include <math.h>
+#include <sched.h>
+#include <time.h>
 #include <signal.h>
 #include <sys/file.h>
 #include <sys/ioctl.h>
@@ -12,73 +17,205 @@
 #include <sys/wait.h>
 #include "circular_array.h"
 #include "memory.h"
+#include "heap.h"
+#include "workload.h"
+#include "worker.h"
+#include "event_loop.h"
+#include "transcript.h"
+#include "trace.h"
+#include "profile.h"
 
+// Building with -DSIMULATE_ONLY leaves out the real processes, so that the simulation itself can be benchmarked. No
+// FINISHED-PROCESS lines are printed then.
+#ifndef SIMULATE_ONLY
 #define IMPLEMENTS_REAL_PROCESS
+#endif
 
-// The number of expected command line arguments
-#define N_ARGC 9
 // The number of bytes after converting an integer value to byte array
 #define N_BYTES 4
-// The maximum length of a line from an input file
-#define MAX_LINE_LEN 35
 // Length of the byte string from the standard output of process upon termination
 #define SHA_LEN 65
 // Used to check if real processes have been created
 #define INIT_PID -1
+// Used for CPUs whose real processes are not pinned to a host core
+#define NO_CORE -1
 
 // Scheduling algorithms
 #define SJF "SJF"
 #define RR "RR"
 
-// Memory strategies
+// Memory strategies, other than those looked up with find_mem_strategy()
 #define INF "infinite"
-#define BF "best-fit"
+
+// Formats of the transcript
+#define TEXT "text"
+#define BINARY "binary"
+// The long option selecting the format of the transcript, returned by getopt_long() as a character no short option
+// uses
+#define TRACE_FORMAT_OPTION "trace-format"
+#define TRACE_FORMAT_OPT 'T'
+// The long option printing how long each phase of the simulation took, in builds with -DPROFILE
+#define PROFILE_OPTION "profile"
+#define PROFILE_OPT 'P'
+
+// Transports between the manager and real processes
+#define PIPE "pipe"
+#define SHM "shm"
+
+// Memory backends
+#define INDEX "index"
+#define BITMAP "bitmap"
+
+// The most CPUs that can be simulated with `-c`
+#define MAX_CPUS 1024
+
+/**
+ * The READY processes. Round Robin keeps them in arrival order in `queue`, and Shortest Job First keeps them in `heap`,
+ * ordered by service time, arrival time, and name. Only the structure for the scheduler in use is allocated.
+*/
+typedef struct ready{
+    circ_array_t *queue;
+    proc_heap_t *heap;
+} ready_t;
+
+/**
+ * A simulated CPU: the process `running` on it, or `NO_PROC` if it is idle, its own READY processes `ready`, and the 
+ * number of `busy_cycles` in which it has run a process. `stopping` is a process that has been sent SIGTSTP this 
+ * cycle but not yet seen to stop, or `NO_PROC`. When pinned, the real processes of the CPU run on host core `core`,
+ * and the `handshakes` with them, each from the time was `sent` until it was echoed, take `handshake_ns` in total.
+*/
+typedef struct cpu{
+    proc_id_t running;
+    ready_t ready;
+    long busy_cycles;
+    proc_id_t stopping;
+    int core;
+    long handshakes;
+    long handshake_ns;
+    struct timespec sent;
+} cpu_t;
 
 //  Simulates a process manager, which checks for running process completion, then performs process submission, memory 
-// allocation, and process scheduling in cycles.
-void manage_processes(FILE *fp, char *scheduler, char *memory_strategy, int quantum);
+// allocation, and process scheduling in cycles, on `n_cpus` CPUs, with their real processes on host cores if `pinned`.
+// Real processes are taken from a pool of `n_workers` pre-spawned workers, if there are any, and are waited on with an
+// event loop if `looped`. Real processes are sent their messages through shared memory channels if `shared`. The 
+// transcript is written to STDOUT by a writer thread if `async_output`, or as a binary trace instead if `binary`.
+void manage_processes(workload_t *workload, char *scheduler, const mem_strategy_t *mem_strategy, int mem_size, int quantum, int event_driven, int n_cpus, int pinned, int n_workers, int looped, int shared, int async_output, int binary);
+
+// Assigns each of `cpus` a host core to pin its real processes to, or `NO_CORE` to all of them if not `pinned`
+void assign_cores(cpu_t *cpus, int n_cpus, int pinned);
+
+// Creates or resumes the real process of every busy CPU of `cpus` for a cycle, after waiting for any suspended this
+// cycle to stop. If `pinned`, the handshakes of all CPUs are driven at the same time. New real processes are taken
+// from `pool` unless it is NULL. With an event `loop`, all CPUs are also driven at the same time, and every wait goes
+// through `loop`. New real processes are given channels if `shared`. Returns the number of busy CPUs.
+int run_cpus(proc_table_t *table, cpu_t *cpus, int n_cpus, long simulation_time, int pinned, worker_pool_t *pool, event_loop_t *loop, int shared);
+
+// Returns the number of cycles after `simulation_time` in which nothing can happen other than the running processes of
+// `cpus` continuing to run
+long quiet_cycles(workload_t *workload, proc_table_t *table, cpu_t *cpus, int n_cpus, circ_array_t *input_queue, memory_t *memory, long simulation_time, int quantum);
+
+// Simulates memory allocation for processes of `table` in `input_queue`. If `memory` is NULL, then memory is infinite 
+// and all processes can be moved from `input_queue` to the READY processes of `cpus`. Otherwise, apply the memory 
+// allocation strategy of `memory`. Admitted processes are written to `transcript` or `trace`.
+void allocate_memory(proc_table_t *table, circ_array_t *input_queue, cpu_t *cpus, int n_cpus, memory_t *memory, long simulation_time, transcript_t *transcript, trace_t *trace);
+
+// Returns the CPU of `cpus` with the fewest READY and running processes, which newly admitted processes are given to
+cpu_t *least_loaded(cpu_t *cpus, int n_cpus);
+
+// Moves process `id` into the READY processes `ready`
+void make_ready(ready_t *ready, proc_id_t id);
 
-// Simulates memory allocation for processes according to `memory_strategy`. If `memory_strategy` is `INF`, then memory
-// is infinite and all processes can be moved from `input_queue` to `ready_queue`. Otherwise, apply the Best Fit memory
-// allocation algorithm. 
-void allocate_memory(circ_array_t *input_queue, circ_array_t *ready_queue, memory_t *memory, char *memory_strategy, long simulation_time);
+// Returns the number of READY processes in `ready`
+int ready_size(ready_t *ready);
 
-// Applies a scheduling algorithm according to `scheduler`, to determine the `running_process` for a cycle. If 
-// `scheduler` is `SJF`, apply the Shortest Job First algorithm. Otherwise, apply the Round Robin algorithm.
-void schedule(circ_array_t *ready_queue, char *scheduler, process_t **running_process, long simulation_time);
+// Returns the number of READY processes across all `cpus`
+int total_ready(cpu_t *cpus, int n_cpus);
 
-// Prints performance statistics: average turnaround time, time overhead (maximum and average), and makespan.
-void print_performance_stats(long total_turnaround, long num_processes, double total_overhead, double max_overhead, long simulation_time);
+// Takes a READY process for the idle CPU `thief` from the CPU of `cpus` with the most READY processes. Returns its id,
+// or `NO_PROC` if no other CPU has any.
+proc_id_t steal(cpu_t *cpus, int n_cpus, cpu_t *thief);
+
+// Applies a scheduling algorithm to determine the running process of `cpu` for a cycle. If its READY processes are
+// ordered by a heap, apply the Shortest Job First algorithm. Otherwise, apply the Round Robin algorithm. An idle CPU
+// with no READY processes of its own steals one from the other `cpus`. The running process is written to `transcript`
+// or `trace`.
+void schedule(proc_table_t *table, cpu_t *cpus, int n_cpus, cpu_t *cpu, long simulation_time, transcript_t *transcript, trace_t *trace);
+
+// Prints that process `id` of `table` is READY at `address`, to `transcript`, or records it in `trace` if it is not 
+// NULL
+void print_ready(proc_table_t *table, proc_id_t id, int address, long simulation_time, transcript_t *transcript, trace_t *trace);
+
+// Prints that process `id` is RUNNING on `cpu`, which is only named when there is more than one of `cpus`, to 
+// `transcript`, or records it in `trace` if it is not NULL
+void print_running(proc_table_t *table, proc_id_t id, cpu_t *cpus, int n_cpus, cpu_t *cpu, long simulation_time, transcript_t *transcript, trace_t *trace);
+
+// Prints that process `id` of `table` is FINISHED with `proc_remaining` processes left, to `transcript`, or records it
+// in `trace` if it is not NULL
+void print_finished(proc_table_t *table, proc_id_t id, int proc_remaining, long simulation_time, transcript_t *transcript, trace_t *trace);
+
+// Prints performance statistics: average turnaround time, time overhead (maximum and average), makespan, and the 
+// utilisation of each of `cpus` if there is more than one, to `transcript`, or records them in `trace` if it is not
+// NULL.
+void print_performance_stats(long total_turnaround, long num_processes, double total_overhead, double max_overhead, long simulation_time, cpu_t *cpus, int n_cpus, int quantum, transcript_t *transcript, trace_t *trace);
+
+// Prints the host core of each of `cpus`, and the number and mean latency of its handshakes, to STDERR, after 
+// flushing `transcript` unless it is NULL
+void print_handshake_stats(cpu_t *cpus, int n_cpus, transcript_t *transcript);
 
 // Converts a given long `value` to a 32-bit representation in `byte_array` with Big Endian Ordering 
 void to_byte_array(long value, uint8_t *byte_array);
 
-// Creates a real process
-void create_process(process_t *running_process, long simulation_time);
+// Creates a real process, with a channel if `shared`, or takes one from `pool` unless it is NULL, pinned to host core
+// `core` unless it is `NO_CORE`, and sends it the `simulation_time`
+void create_process(process_t *running_process, long simulation_time, int core, worker_pool_t *pool, int shared);
 
-// Resumes a real process
+// Resumes a real process, sending it the `simulation_time`
 void resume_process(process_t *running_process, long simulation_time);
 
-// Suspends a real process
+// Waits for a real process that has been created or resumed to echo the `simulation_time` it was sent
+void await_process(process_t *running_process, long simulation_time);
+
+// Suspends a real process, sending it the `simulation_time`
 void suspend_process(process_t *running_process, long simulation_time);
 
-// Terminates a real process
-void terminate_process(process_t *running_process, long simulation_time);
+// Waits for a real process that has been suspended to stop
+void await_stop(process_t *process);
+
+// Terminates the real process of process `id` of `table`, returning it to `pool` instead if it came from there, and 
+// waiting for it to exit through `loop` unless it is NULL. Prints its sha to `transcript` or `trace`.
+void terminate_process(proc_table_t *table, proc_id_t id, long simulation_time, worker_pool_t *pool, event_loop_t *loop, transcript_t *transcript, trace_t *trace);
+
+// Prints that process `id` of `table` has FINISHED-PROCESS with `sha`, to `transcript`, or records it in `trace` if it
+// is not NULL
+void print_finished_process(proc_table_t *table, proc_id_t id, const char *sha, long simulation_time, transcript_t *transcript, trace_t *trace);
 
 int main(int argc, char* argv[]){
     int opt;
-    char *filename;
-    char *scheduler;
-    char *memory_strategy;
-    int quantum;
-
-    if (argc != N_ARGC){
-        fprintf(stderr, "Error: malformed command line arguments\n");
-        exit(EXIT_FAILURE);
-    }
+    char *filename = NULL;
+    char *scheduler = NULL;
+    char *memory_strategy = NULL;
+    int mem_backend = MEM_INDEX;
+    long mem_size = MEM_SIZE;
+    int quantum = 0;
+    int event_driven = 0;
+    int pipelined = 0;
+    int n_cpus = 1;
+    int pinned = 0;
+    int n_workers = 0;
+    int looped = 0;
+    int shared = 0;
+    int async_output = 0;
+    int binary = 0;
+    int profiled = 0;
+    struct option long_options[] = {
+        {TRACE_FORMAT_OPTION, required_argument, NULL, TRACE_FORMAT_OPT},
+        {PROFILE_OPTION, no_argument, NULL, PROFILE_OPT},
+        {NULL, 0, NULL, 0}
+    };
 
     // Parse command-line arguments
-    while ((opt = getopt(argc, argv, ":f:s:m:q:")) != -1){
+    while ((opt = getopt_long(argc, argv, ":f:s:m:q:b:M:epc:aw:lt:W", long_options, NULL)) != -1){
         if (opt == 'f'){
             filename = optarg;
         }
@@ -91,38 +228,148 @@ int main(int argc, char* argv[]){
         else if (opt == 'q'){
             quantum = atoi(optarg);
         } 
+        else if (opt == 'b' && strcmp(optarg, BITMAP) == 0){
+            mem_backend = MEM_BITMAP;
+        }
+        else if (opt == 'b' && strcmp(optarg, INDEX) == 0){
+            mem_backend = MEM_INDEX;
+        }
+        else if (opt == 'M'){
+            mem_size = strtol(optarg, NULL, 10);
+        }
+        else if (opt == 'e'){
+            event_driven = 1;
+        }
+        else if (opt == 'p'){
+            pipelined = 1;
+        }
+        else if (opt == 'c'){
+            n_cpus = atoi(optarg);
+        }
+        else if (opt == 'a'){
+            pinned = 1;
+        }
+        else if (opt == 'w'){
+            n_workers = atoi(optarg);
+        }
+        else if (opt == 'l'){
+            looped = 1;
+        }
+        else if (opt == 't' && strcmp(optarg, SHM) == 0){
+            shared = 1;
+        }
+        else if (opt == 't' && strcmp(optarg, PIPE) == 0){
+            shared = 0;
+        }
+        else if (opt == 'W'){
+            async_output = 1;
+        }
+        else if (opt == TRACE_FORMAT_OPT && strcmp(optarg, BINARY) == 0){
+            binary = 1;
+        }
+        else if (opt == TRACE_FORMAT_OPT && strcmp(optarg, TEXT) == 0){
+            binary = 0;
+        }
+        else if (opt == PROFILE_OPT){
+            profiled = 1;
+        }
+        else {
+            fprintf(stderr, "Error: malformed command line arguments\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // `-f`, `-s`, `-m` and `-q` are required, `-b`, `-M`, `-e`, `-p`, `-c`, `-a`, `-w`, `-l`, `-t`, `-W`, `--trace-format` and `--profile` are optional
+    if (filename == NULL || scheduler == NULL || memory_strategy == NULL || quantum <= 0 || mem_size <= 0 
+        || mem_size > MAX_MEM_SIZE || n_cpus <= 0 || n_cpus > MAX_CPUS || n_workers < 0){
+        fprintf(stderr, "Error: malformed command line arguments\n");
+        exit(EXIT_FAILURE);
     }
 
-    FILE *fp = fopen(filename, "r");
-    if (fp == NULL){
-        perror("fopen");
+    // Pooled workers and the event loop both wait on pipes, which processes with a channel do not have
+    if (shared && (n_workers > 0 || looped)){
+        fprintf(stderr, "Error: -t %s cannot be used with -w or -l\n", SHM);
         exit(EXIT_FAILURE);
     }
 
-    manage_processes(fp, scheduler, memory_strategy, quantum);
+    // Every real process hashes the time it is resumed with in every cycle it runs, so none of those cycles can be 
+    // skipped, and only a build without real processes is event-driven
+#ifdef IMPLEMENTS_REAL_PROCESS
+    if (event_driven){
+        fprintf(stderr, "Error: -e needs a build with -DSIMULATE_ONLY, such as allocate_sim\n");
+        exit(EXIT_FAILURE);
+    }
+#endif
+
+    // Without -DPROFILE the probes are compiled out, and there is nothing to print
+#ifndef PROFILE
+    if (profiled){
+        fprintf(stderr, "Error: --%s needs a build with -DPROFILE, such as allocate_profile\n", PROFILE_OPTION);
+        exit(EXIT_FAILURE);
+    }
+#endif
+
+    // Look up the memory allocation strategy once, infinite memory has no strategy
+    const mem_strategy_t *mem_strategy = NULL;
+    if (strcmp(memory_strategy, INF) != 0){
+        mem_strategy = find_mem_strategy(memory_strategy, mem_backend);
+        if (mem_strategy == NULL){
+            fprintf(stderr, "Error: unknown memory strategy %s\n", memory_strategy);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // The event loop takes SIGCHLD through a signalfd, so it is blocked before the parser thread can be started
+    if (looped){
+        block_child_signals();
+    }
+
+    // The input file is parsed once up front, rather than re-read every cycle, or parsed ahead on its own thread
+    workload_t *workload = load_workload(filename, pipelined);
+
+    manage_processes(workload, scheduler, mem_strategy, mem_size, quantum, event_driven, n_cpus, pinned, n_workers, looped, shared, async_output, binary);
+
+    // The transcript has been flushed by now, so the profile follows it
+#ifdef PROFILE
+    if (profiled){
+        print_profile(stderr);
+    }
+#endif
     
-    fclose(fp);
+    free_workload(workload);
     return 0;
 }
 
 /**
- * Simulates a process manager, which runs in cycles. At the beginning of each cycle, checks if the `running_process`
- * has completed execution, and terminates the process if so. Next, checks for processes that have been submitted
- * to the system since the last cycle, where processes are considered to be submitted if their `time_arr` is less than
- * or equal to the current `simulation_time`. Processes that have arrived are inserted into the `input_queue`. Then, 
- * attempts to allocate memory to processes in the `input_queue`. Processes with successful memory allocation are moved
- * to the `ready_queue`. A scheduler (`SJF` or `RR`) will then determine which process gets to run for this cycle.
- * The cycle repeats until no processes remain.
+ * Simulates a process manager, which runs in cycles on `n_cpus` CPUs. At the beginning of each cycle, checks if the
+ * running process of each CPU has completed execution, and terminates the process if so. Next, checks for processes 
+ * that have been submitted to the system since the last cycle, where processes are considered to be submitted if their
+ * `time_arr` is less than or equal to the current `simulation_time`. Processes that have arrived are inserted into the
+ * `input_queue`. Then, attempts to allocate memory to processes in the `input_queue`. Processes with successful memory
+ * allocation are moved to the READY processes of the least loaded CPU. A scheduler (`SJF` or `RR`) will then determine
+ * which process gets to run on each CPU for this cycle, in order of CPU. The cycle repeats until no processes remain. 
+ * If `event_driven` is set, which only a build without real processes allows, cycles in which nothing can happen 
+ * other than the running processes continuing are skipped over, jumping straight to the cycle of the next event. If `pinned`, the real processes of each CPU run on
+ * their own host core, and are driven in parallel. If `n_workers` is positive, that many real processes are spawned up
+ * front, and each is reused for one simulated process after another. If `looped`, every real process is waited on 
+ * through one event loop. If `shared`, real processes are sent their messages through shared memory channels instead
+ * of signals and pipes. The transcript is buffered and written to STDOUT in batches, by a writer thread of its own if
+ * `async_output`. If `binary`, the transcript is written as varint-encoded records to a binary trace in the file STDOUT
+ * is redirected to instead, which can be rendered back into text with "render_trace".
 */
-void manage_processes(FILE *fp, char *scheduler, char *memory_strategy, int quantum){
+void manage_processes(workload_t *workload, char *scheduler, const mem_strategy_t *mem_strategy, int mem_size, int quantum, int event_driven, int n_cpus, int pinned, int n_workers, int looped, int shared, int async_output, int binary){
     
-    long last_fp = 0;
-    char line[MAX_LINE_LEN];
-    unsigned int time_arr;
-    char name[MAX_NAME_LEN];
-    long serv_time;
-    int mem_req;
-    process_t *running_process = NULL;
+    // Every process lives in `table`, and is referred to by its id everywhere else
+    proc_table_t *table = new_proc_table();
+    // The transcript goes to exactly one of `transcript` and `trace`, and the other is NULL
+    transcript_t *transcript = NULL;
+    trace_t *trace = NULL;
+    if (binary){
+        trace = new_trace(STDOUT_FILENO);
+    }
+    else {
+        transcript = new_transcript(STDOUT_FILENO, async_output);
+    }
 
     // Variables for calculating performance statistics
     long simulation_time = 0;
@@ -132,190 +379,589 @@ void manage_processes(FILE *fp, char *scheduler, char *memory_strategy, int quan
     double max_overhead = 0;
     
     circ_array_t *input_queue = new_circular_array();
-    circ_array_t *ready_queue = new_circular_array();
-    memory_t *memory = new_mem_array();
+    cpu_t *cpus = (cpu_t *)malloc(sizeof(cpu_t)*n_cpus);
+    assert(cpus);
+    for (int c = 0; c < n_cpus; c++){
+        cpus[c].running = NO_PROC;
+        cpus[c].ready.queue = NULL;
+        cpus[c].ready.heap = NULL;
+        cpus[c].busy_cycles = 0;
+        cpus[c].stopping = NO_PROC;
+        cpus[c].handshakes = 0;
+        cpus[c].handshake_ns = 0;
+        if (strcmp(scheduler, SJF) == 0){
+            cpus[c].ready.heap = new_heap(table);
+        }
+        else {
+            cpus[c].ready.queue = new_circular_array();
+        }
+    }
+    assign_cores(cpus, n_cpus, pinned);
+    worker_pool_t *pool = NULL;
+    if (n_workers > 0){
+        pool = new_worker_pool(n_workers);
+    }
+    event_loop_t *loop = NULL;
+    if (looped){
+        loop = new_event_loop(table);
+    }
+    memory_t *memory = NULL;
+    if (mem_strategy != NULL){
+        memory = new_mem_array(mem_strategy, mem_size);
+    }
 
+    PROFILE_BEGIN(simulation_start);
     while (1){
-        if (running_process != NULL){
-            running_process->serv_time_remaining -= quantum;
+        for (int c = 0; c < n_cpus; c++){
+            proc_id_t running_process = cpus[c].running;
+            if (running_process == NO_PROC){
+                continue;
+            }
+            table->serv_time_remaining[running_process] -= quantum;
             
-            // Check if the currently `running_process` has been completed
-            if (running_process->serv_time_remaining <= 0){
-                printf("%ld,FINISHED,process_name=%s,proc_remaining=%d\n", simulation_time, running_process->name, input_queue->size+ready_queue->size);
+            // Check if the `running_process` of this CPU has been completed
+            if (table->serv_time_remaining[running_process] <= 0){
+                print_finished(table, running_process, input_queue->size+total_ready(cpus, n_cpus), simulation_time, transcript, trace);
                 
-                long turnaround_time = simulation_time - running_process->time_arr;
+                long turnaround_time = simulation_time - table->time_arr[running_process];
                 total_turnaround += turnaround_time;
                 
-                double overhead_time = turnaround_time/(double)running_process->serv_time;
+                double overhead_time = turnaround_time/(double)table->serv_time[running_process];
                 total_overhead += overhead_time;
                 if (overhead_time > max_overhead){
                     max_overhead = overhead_time;
                 }
                 num_processes++;
 
-                // If Best Fit memory allocation algorithm is being simulated, deallocate the `memory`
-                if (strcmp(memory_strategy, BF) == 0){
-                    deallocate(memory, running_process);
+                // If memory is not infinite, deallocate the `memory`
+                if (memory != NULL){
+                    deallocate(memory, table->mem_addr[running_process], table->mem_req[running_process]);
                 }
 
-                terminate_process(running_process, simulation_time);
+#ifdef IMPLEMENTS_REAL_PROCESS
+                PROFILE_BEGIN(terminate_start);
+                terminate_process(table, running_process, simulation_time, pool, loop, transcript, trace);
+                PROFILE_END(PROBE_TERMINATE_PROCESS, terminate_start);
+#endif
                 
-                free(running_process);
-                running_process = NULL;
+                free_process(table, running_process);
+                cpus[c].running = NO_PROC;
             }
         }
 
         // Check if any processes have been submitted to the system, and add them to the `input_queue`
-        while (fgets(line, MAX_LINE_LEN, fp)){
-            sscanf(line, "%u %s %ld %d", &time_arr, name, &serv_time, &mem_req);
-            if (time_arr <= simulation_time){
-                process_t *process = malloc(sizeof(process_t));
-                assert(process);
-                process->time_arr = time_arr;
-                strcpy(process->name, name);
-                process->serv_time = serv_time;
-                process->serv_time_remaining = serv_time;
-                process->mem_req = mem_req;
-                process->mem_addr = INIT_ADDR;
-                process->pid = INIT_PID;
-                enqueue(input_queue, process);
+        PROFILE_BEGIN(input_start);
+        while (peek_arrival(workload) != NO_ARRIVAL && peek_arrival(workload) <= simulation_time){
+            proc_id_t id = new_process(table);
+            read_arrival(workload, table, id);
+            table->mem_addr[id] = INIT_ADDR;
+            table->processes[id].pid = INIT_PID;
+            table->processes[id].pidfd = NO_PIDFD;
+            table->processes[id].channel = NULL;
+            if (trace != NULL){
+                trace_name(trace, id, table->processes[id].name);
             }
-            // Reset `fp` to `last_fp` if no more processes are submitted
-            else {
-                fseek(fp, last_fp, SEEK_SET);
-                break;
-            }
-            last_fp = ftell(fp);
+            enqueue(input_queue, id);
         }
+        PROFILE_END(PROBE_INPUT_SCAN, input_start);
 
         // Perform memory allocation
-        allocate_memory(input_queue, ready_queue, memory, memory_strategy, simulation_time);
+        PROFILE_BEGIN(allocate_start);
+        allocate_memory(table, input_queue, cpus, n_cpus, memory, simulation_time, transcript, trace);
+        PROFILE_END(PROBE_ALLOCATE_MEMORY, allocate_start);
         
-        // Determine the `running_process` for this cycle
-        schedule(ready_queue, scheduler, &running_process, simulation_time);
-        if (running_process != NULL){
-            // When a scheduling algorithm selects a process to run for the first time, the process is created. 
-            // Otherwise, it is resumed.
-            if (running_process->pid == INIT_PID){
-                create_process(running_process, simulation_time);
-            }
-            else {
-                resume_process(running_process, simulation_time);
-            }
+        // Determine the running process of each CPU for this cycle, then run them
+        for (int c = 0; c < n_cpus; c++){
+            PROFILE_BEGIN(schedule_start);
+            schedule(table, cpus, n_cpus, &cpus[c], simulation_time, transcript, trace);
+            PROFILE_END(PROBE_SCHEDULE, schedule_start);
         }
+        int n_running = run_cpus(table, cpus, n_cpus, simulation_time, pinned, pool, loop, shared);
         
-        // There are no more processes in the input file, `input_queue`, `ready_queue`, and no `running_process`,
+        // There are no more processes in the input file, `input_queue`, READY on any CPU, and no running processes,
         // the simulation is complete!
-        if (feof(fp) && running_process == NULL && input_queue->size == 0 && ready_queue->size == 0){
-            print_performance_stats(total_turnaround, num_processes, total_overhead, max_overhead, simulation_time);
+        if (workload_done(workload) && n_running == 0 && input_queue->size == 0 && total_ready(cpus, n_cpus) == 0){
+            print_performance_stats(total_turnaround, num_processes, total_overhead, max_overhead, simulation_time, cpus, n_cpus, quantum, transcript, trace);
+            if (pinned){
+                print_handshake_stats(cpus, n_cpus, transcript);
+            }
             break;
         }
+
+        // In event-driven mode, jump over the cycles in which the only thing that happens is the running processes
+        // continuing, all at once
+        if (event_driven){
+            long skip = quiet_cycles(workload, table, cpus, n_cpus, input_queue, memory, simulation_time, quantum);
+            simulation_time += skip*quantum;
+            for (int c = 0; c < n_cpus; c++){
+                if (cpus[c].running != NO_PROC){
+                    table->serv_time_remaining[cpus[c].running] -= skip*quantum;
+                    cpus[c].busy_cycles += skip;
+                }
+            }
+        }
         simulation_time += quantum;
     }
+    PROFILE_END(PROBE_SIMULATION, simulation_start);
 
-    free(memory);
+    if (memory != NULL){
+        free_mem_array(memory);
+    }
+    if (pool != NULL){
+        free_worker_pool(pool);
+    }
+    if (loop != NULL){
+        free_event_loop(loop);
+    }
     free_array(input_queue);
-    free_array(ready_queue);
+    for (int c = 0; c < n_cpus; c++){
+        if (cpus[c].ready.heap != NULL){
+            free_heap(cpus[c].ready.heap);
+        }
+        else {
+            free_array(cpus[c].ready.queue);
+        }
+    }
+    free(cpus);
+    free_proc_table(table);
+    if (transcript != NULL){
+        free_transcript(transcript);
+    }
+    else {
+        free_trace(trace);
+    }
+}
+
+/**
+ * Assigns each of `cpus` a host core to pin its real processes to. The cores are those this process may run on, in
+ * order, and are shared round robin if there are more CPUs than cores. If not `pinned`, every CPU gets `NO_CORE`.
+*/
+void assign_cores(cpu_t *cpus, int n_cpus, int pinned){
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (pinned && sched_getaffinity(0, sizeof(allowed), &allowed) == -1){
+        perror("sched_getaffinity");
+        exit(EXIT_FAILURE);
+    }
+
+    int core = -1;
+    for (int c = 0; c < n_cpus; c++){
+        cpus[c].core = NO_CORE;
+        if (!pinned){
+            continue;
+        }
+        // Find the next allowed core after the last one assigned, wrapping around
+        do {
+            core = (core+1)%CPU_SETSIZE;
+        }
+        while (!CPU_ISSET(core, &allowed));
+        cpus[c].core = core;
+    }
+}
+
+/**
+ * Creates or resumes the real process of every busy CPU of `cpus` for a cycle, after waiting for any process suspended
+ * by the scheduler this cycle to stop. When a scheduling algorithm selects a process to run for the first time, the 
+ * process is created. Otherwise, it is resumed. Each handshake is three steps: waiting for the stop, sending the 
+ * `simulation_time` and signal, and waiting for the echo. Unpinned, one CPU's steps are all taken before the next
+ * CPU's. If `pinned`, or with an event `loop`, each step is taken for every CPU before the next step, so that the 
+ * children handle their signals at the same time. With `loop`, each wait is for every CPU at once, and is over as soon
+ * as the last child gets to it, in whatever order they do. The messages each child receives are the same either way.
+ * New real processes are taken from `pool` unless it is NULL, and are given channels if `shared`. Returns the number
+ * of busy CPUs.
+*/
+int run_cpus(proc_table_t *table, cpu_t *cpus, int n_cpus, long simulation_time, int pinned, worker_pool_t *pool, event_loop_t *loop, int shared){
+    int batch = pinned || loop != NULL ? n_cpus : 1;
+    int n_running = 0;
+
+#ifndef IMPLEMENTS_REAL_PROCESS
+    // Without real processes, running a cycle only counts the busy CPUs
+    for (int c = 0; c < n_cpus; c++){
+        if (cpus[c].running != NO_PROC){
+            cpus[c].busy_cycles++;
+            n_running++;
+        }
+    }
+    return n_running;
+#endif
+
+    for (int first = 0; first < n_cpus; first += batch){
+        int last = first+batch;
+        for (int c = first; c < last; c++){
+            if (cpus[c].stopping != NO_PROC && loop != NULL){
+                await_event(loop, cpus[c].stopping, AWAIT_STOP);
+            }
+            else if (cpus[c].stopping != NO_PROC){
+                await_stop(&table->processes[cpus[c].stopping]);
+            }
+            cpus[c].stopping = NO_PROC;
+        }
+        if (loop != NULL){
+            run_event_loop(loop);
+        }
+
+        for (int c = first; c < last; c++){
+            proc_id_t id = cpus[c].running;
+            if (id == NO_PROC){
+                continue;
+            }
+            process_t *process = &table->processes[id];
+            clock_gettime(CLOCK_MONOTONIC, &cpus[c].sent);
+            if (process->pid == INIT_PID){
+                PROFILE_BEGIN(create_start);
+                create_process(process, simulation_time, cpus[c].core, pool, shared);
+                PROFILE_END(PROBE_CREATE_PROCESS, create_start);
+                if (loop != NULL){
+                    watch_process(loop, id);
+                }
+            }
+            else {
+                PROFILE_BEGIN(resume_start);
+                resume_process(process, simulation_time);
+                PROFILE_END(PROBE_RESUME_PROCESS, resume_start);
+            }
+            if (loop != NULL){
+                uint8_t byte_array[N_BYTES];
+                to_byte_array(simulation_time, byte_array);
+                process->echo = byte_array[N_BYTES-1];
+                await_event(loop, id, AWAIT_ECHO);
+            }
+        }
+        if (loop != NULL){
+            run_event_loop(loop);
+        }
+
+        for (int c = first; c < last; c++){
+            if (cpus[c].running == NO_PROC){
+                continue;
+            }
+            struct timespec echoed;
+            if (loop == NULL){
+                await_process(&table->processes[cpus[c].running], simulation_time);
+            }
+            clock_gettime(CLOCK_MONOTONIC, &echoed);
+            cpus[c].handshake_ns += (echoed.tv_sec-cpus[c].sent.tv_sec)*1000000000L + echoed.tv_nsec-cpus[c].sent.tv_nsec;
+            cpus[c].handshakes++;
+            cpus[c].busy_cycles++;
+            n_running++;
+        }
+    }
+    return n_running;
+}
+
+/**
+ * Returns the number of cycles after `simulation_time` in which nothing can happen other than the running processes
+ * of `cpus` continuing to run. This is called at the end of a cycle, and the next event is whichever comes first of a
+ * running process finishing, or the next process in the input file arriving. No cycles are quiet while a CPU has READY
+ * processes that Round Robin could preempt with or that an idle CPU could run or steal, or while infinite memory still
+ * has processes in `input_queue` to admit. Otherwise, processes left in `input_queue` cannot be admitted until memory
+ * is freed, which only happens when a running process finishes.
+*/
+long quiet_cycles(workload_t *workload, proc_table_t *table, cpu_t *cpus, int n_cpus, circ_array_t *input_queue, memory_t *memory, long simulation_time, int quantum){
+    if (memory == NULL && input_queue->size > 0){
+        return 0;
+    }
+    int n_ready = total_ready(cpus, n_cpus);
+    for (int c = 0; c < n_cpus; c++){
+        if (ready_size(&cpus[c].ready) > 0 && cpus[c].ready.heap == NULL){
+            return 0;
+        }
+        if (n_ready > 0 && cpus[c].running == NO_PROC){
+            return 0;
+        }
+    }
+
+    // The number of cycles until the next event, rounded up to a whole number of quanta
+    long cycles = LONG_MAX;
+    for (int c = 0; c < n_cpus; c++){
+        if (cpus[c].running != NO_PROC){
+            long until_finish = (table->serv_time_remaining[cpus[c].running] + quantum - 1)/quantum;
+            if (until_finish < cycles){
+                cycles = until_finish;
+            }
+        }
+    }
+    long time_arr = peek_arrival(workload);
+    if (time_arr != NO_ARRIVAL){
+        long until_arrival = (time_arr - simulation_time + quantum - 1)/quantum;
+        if (until_arrival < cycles){
+            cycles = until_arrival;
+        }
+    }
+
+    // With no event to wait for, step one cycle at a time as usual
+    if (cycles == LONG_MAX || cycles < 1){
+        return 0;
+    }
+    return cycles-1;
 }
 
 /**
- * Simulates memory allocation for processes according to `memory_strategy`. If `memory_strategy` is `INF`, then memory
- * is infinite and all processes can be moved from `input_queue` to `ready_queue`. Otherwise, apply the Best Fit memory
- * allocation algorithm.
+ * Simulates memory allocation for processes of `table` in `input_queue`. If `memory` is NULL, then memory is infinite
+ * and all processes can be moved from `input_queue` to the READY processes of `cpus`. Otherwise, apply the memory 
+ * allocation strategy of `memory`, which was chosen once at startup. Only the `mem_req` column of `table` is read 
+ * while trying each process, and the cold name is only read once a process is admitted. Each admitted process goes to
+ * the least loaded CPU.
 */
-void allocate_memory(circ_array_t *input_queue, circ_array_t *ready_queue, memory_t *memory, char *memory_strategy, long simulation_time){
+void allocate_memory(proc_table_t *table, circ_array_t *input_queue, cpu_t *cpus, int n_cpus, memory_t *memory, long simulation_time, transcript_t *transcript, trace_t *trace){
     
-    // There is infinite memory, all arrived processes automatically enter the READY state
-    if (strcmp(memory_strategy, INF) == 0){
-        for (int i = 0; i < input_queue->size; i++){
-            process_t *ready_process = dequeue(input_queue);
-            enqueue(ready_queue, ready_process);
+    // There is infinite memory, all arrived processes automatically enter the READY state. Round Robin on a single CPU
+    // takes the whole `input_queue` onto the tail of its queue at once.
+    if (memory == NULL){
+        if (n_cpus == 1 && cpus[0].ready.heap == NULL){
+            splice_array(cpus[0].ready.queue, input_queue);
+        }
+        while (input_queue->size > 0){
+            make_ready(&least_loaded(cpus, n_cpus)->ready, dequeue(input_queue));
         }
     }
     else {
-        // Default to Best-Fit memory allocation algorithm otherwise, iterating over each process in `input_queue`
+        // Otherwise, apply the memory allocation strategy to each process in `input_queue`. Processes that stay are
+        // compacted towards the head as the pass goes, so they keep their order and the pass stays O(n).
+        int kept = 0;
         for (int i = 0; i < input_queue->size; i++){
-            process_t *process = get_process(input_queue, i);
+            proc_id_t id = get_process(input_queue, i);
+            int address = mem_allocate(memory, table->mem_req[id]);
 
             // Successful memory allocation!
-            if (allocate_best_fit(memory, process) != INIT_ADDR){
-                printf("%ld,READY,process_name=%s,assigned_at=%d\n", simulation_time, process->name, process->mem_addr);
-                process_t *ready_process = remove_process(input_queue, i);
-                enqueue(ready_queue, ready_process);
-                i--;
+            if (address != INIT_ADDR){
+                table->mem_addr[id] = address;
+                print_ready(table, id, address, simulation_time, transcript, trace);
+                make_ready(&least_loaded(cpus, n_cpus)->ready, id);
+            }
+            else {
+                set_process(input_queue, kept++, id);
             }
         }
+        truncate_array(input_queue, kept);
     }
 }
 
 /**
- * Applies a scheduling algorithm according to `scheduler`, to determine the `running_process` for a cycle. If 
- * `scheduler` is `SJF`, apply the Shortest Job First algorithm. Otherwise, apply the Round Robin algorithm.
+ * Returns the CPU of `cpus` with the fewest READY and running processes, with ties going to the lowest numbered CPU,
+ * so that the choice is deterministic.
 */
-void schedule(circ_array_t *ready_queue, char *scheduler, process_t **running_process, long simulation_time){
-    
-    // Apply the Shortest Job First scheduling algorithm
-    if (strcmp(scheduler, SJF) == 0){
-        if (*running_process == NULL && ready_queue->size > 0){
-            // Make a temporary array to use with qsort()
-            process_t *temp_array = (process_t*)malloc(sizeof(process_t)*ready_queue->size);
-            for (int i = 0; i < ready_queue->size; i++){
-                temp_array[i].time_arr = get_process(ready_queue, i)->time_arr;
-                strcpy(temp_array[i].name, get_process(ready_queue, i)->name);
-                temp_array[i].serv_time = get_process(ready_queue, i)->serv_time;
-                temp_array[i].serv_time_remaining = get_process(ready_queue, i)->serv_time_remaining;
-                temp_array[i].mem_req = get_process(ready_queue, i)->mem_req;
-                temp_array[i].mem_addr = get_process(ready_queue, i)->mem_addr;
-            }
+cpu_t *least_loaded(cpu_t *cpus, int n_cpus){
+    cpu_t *best = &cpus[0];
+    int best_load = INT_MAX;
+    for (int c = 0; c < n_cpus; c++){
+        int load = ready_size(&cpus[c].ready) + (cpus[c].running != NO_PROC);
+        if (load < best_load){
+            best = &cpus[c];
+            best_load = load;
+        }
+    }
+    return best;
+}
+
+/**
+ * Moves process `id` into the READY processes `ready`: onto the heap for Shortest Job First, or the tail of the queue 
+ * for Round Robin.
+*/
+void make_ready(ready_t *ready, proc_id_t id){
+    if (ready->heap != NULL){
+        heap_push(ready->heap, id);
+    }
+    else {
+        enqueue(ready->queue, id);
+    }
+}
 
-            qsort(temp_array, ready_queue->size, sizeof(process_t), qsort_comparator);
-            char *process_to_schedule = temp_array[0].name;
+// Returns the number of READY processes in `ready`.
+int ready_size(ready_t *ready){
+    return ready->heap != NULL ? ready->heap->size : ready->queue->size;
+}
 
-            // Determine the `running_process` by its unique name
-            for (int i = 0; i < ready_queue->size; i++){
-                if (strcmp(get_process(ready_queue, i)->name, process_to_schedule) == 0){
-                    *running_process = remove_process(ready_queue, i);
-                    printf("%ld,RUNNING,process_name=%s,remaining_time=%ld\n", simulation_time, (*running_process)->name, (*running_process)->serv_time_remaining);
-                    free(temp_array);
-                    return;
-                }
-            }
+// Returns the number of READY processes across all `cpus`.
+int total_ready(cpu_t *cpus, int n_cpus){
+    int n_ready = 0;
+    for (int c = 0; c < n_cpus; c++){
+        n_ready += ready_size(&cpus[c].ready);
+    }
+    return n_ready;
+}
+
+/**
+ * Takes a READY process for the idle CPU `thief` from the CPU of `cpus` with the most READY processes, with ties going
+ * to the lowest numbered CPU. Shortest Job First takes the shortest job of that CPU, and Round Robin takes the process
+ * at the tail of its queue, which joined it last and so has waited there the least, leaving the head of the queue to
+ * run next on its own CPU as it would have. Returns the id of the process, or `NO_PROC` if no other CPU has any READY
+ * processes.
+*/
+proc_id_t steal(cpu_t *cpus, int n_cpus, cpu_t *thief){
+    cpu_t *victim = NULL;
+    for (int c = 0; c < n_cpus; c++){
+        if (&cpus[c] != thief && ready_size(&cpus[c].ready) > 0 
+            && (victim == NULL || ready_size(&cpus[c].ready) > ready_size(&victim->ready))){
+            victim = &cpus[c];
+        }
+    }
+    if (victim == NULL){
+        return NO_PROC;
+    }
+    if (victim->ready.heap != NULL){
+        return heap_pop(victim->ready.heap);
+    }
+    return remove_process(victim->ready.queue, victim->ready.queue->size-1);
+}
+
+/**
+ * Applies a scheduling algorithm to determine the running process of `cpu` for a cycle. If its READY processes are 
+ * ordered by a heap, apply the Shortest Job First algorithm. Otherwise, apply the Round Robin algorithm. When `cpu` is
+ * idle and has no READY processes of its own, it steals one from the other `cpus`.
+*/
+void schedule(proc_table_t *table, cpu_t *cpus, int n_cpus, cpu_t *cpu, long simulation_time, transcript_t *transcript, trace_t *trace){
+    circ_array_t *ready_queue = cpu->ready.queue;
+
+    // An idle CPU with nothing to run steals from the busiest CPU
+    if (cpu->running == NO_PROC && ready_size(&cpu->ready) == 0){
+        cpu->running = steal(cpus, n_cpus, cpu);
+        if (cpu->running != NO_PROC){
+            print_running(table, cpu->running, cpus, n_cpus, cpu, simulation_time, transcript, trace);
+        }
+        return;
+    }
+    
+    // Apply the Shortest Job First scheduling algorithm, where the shortest job is at the top of the heap
+    if (cpu->ready.heap != NULL){
+        if (cpu->running == NO_PROC && cpu->ready.heap->size > 0){
+            cpu->running = heap_pop(cpu->ready.heap);
+            print_running(table, cpu->running, cpus, n_cpus, cpu, simulation_time, transcript, trace);
         }
-        
     }
     else {
-        // Default to the Round Robin scheduling algorithm if scheduler isn't `SJF`
+        // Default to the Round Robin scheduling algorithm if the scheduler isn't `SJF`
         // If there are no other READY processes, there are no other processes to schedule, so just return
         if (ready_queue->size == 0){
             return;
         }
 
-        // If there are other READY processes but no current `running_process`, dequeue from `ready_queue`
-        if (*running_process == NULL){
-            *running_process = dequeue(ready_queue);
-            printf("%ld,RUNNING,process_name=%s,remaining_time=%ld\n", simulation_time, (*running_process)->name, (*running_process)->serv_time_remaining);
+        // If there are other READY processes but no current running process, dequeue from `ready_queue`
+        if (cpu->running == NO_PROC){
+            cpu->running = dequeue(ready_queue);
+            print_running(table, cpu->running, cpus, n_cpus, cpu, simulation_time, transcript, trace);
             return;
         }
 
-        // If there are other READY processes, the current `running_process` enters the `ready_queue`, and another 
-        // process is scheduled to run. The real `running_process` is also suspended here.
-        suspend_process(*running_process, simulation_time);
-        enqueue(ready_queue, *running_process);
-        *running_process = dequeue(ready_queue);
-        printf("%ld,RUNNING,process_name=%s,remaining_time=%ld\n", simulation_time, (*running_process)->name, (*running_process)->serv_time_remaining);
+        // If there are other READY processes, the current running process enters the `ready_queue`, and another 
+        // process is scheduled to run. The real running process is also suspended here, and seen to stop before any
+        // process is run this cycle.
+#ifdef IMPLEMENTS_REAL_PROCESS
+        PROFILE_BEGIN(suspend_start);
+        suspend_process(&table->processes[cpu->running], simulation_time);
+        PROFILE_END(PROBE_SUSPEND_PROCESS, suspend_start);
+        cpu->stopping = cpu->running;
+#endif
+        enqueue(ready_queue, cpu->running);
+        cpu->running = dequeue(ready_queue);
+        print_running(table, cpu->running, cpus, n_cpus, cpu, simulation_time, transcript, trace);
         
     }
     return;
 }
 
 /**
- * Prints performance statistics: average turnaround time, time overhead (maximum and average), and makespan.
+ * Prints that process `id` of `table` is READY, with its memory starting at `address`, to `transcript`, or records it
+ * in `trace` if it is not NULL.
 */
-void print_performance_stats(long total_turnaround, long num_processes, double total_overhead, double max_overhead, long simulation_time){
-    
-    printf("Turnaround time %.0f\n", ceil(total_turnaround/(double)num_processes));
-    printf("Time overhead %.2f %.2f\n", round(max_overhead*100)/100, round((total_overhead/(double)num_processes)*100)/100);
-    printf("Makespan %ld\n", simulation_time);
+void print_ready(proc_table_t *table, proc_id_t id, int address, long simulation_time, transcript_t *transcript, trace_t *trace){
+    if (trace != NULL){
+        trace_event(trace, TRACE_READY, simulation_time, id, 0, address);
+        return;
+    }
+    transcript_long(transcript, simulation_time);
+    transcript_str(transcript, ",READY,process_name=");
+    transcript_str(transcript, table->processes[id].name);
+    transcript_str(transcript, ",assigned_at=");
+    transcript_long(transcript, address);
+    transcript_end_line(transcript);
+}
+
+/**
+ * Prints that process `id` is RUNNING on `cpu` to `transcript`, or records it in `trace` if it is not NULL. With more
+ * than one of `cpus`, the number of the CPU is added to the end of the line.
+*/
+void print_running(proc_table_t *table, proc_id_t id, cpu_t *cpus, int n_cpus, cpu_t *cpu, long simulation_time, transcript_t *transcript, trace_t *trace){
+    if (trace != NULL){
+        trace_event(trace, TRACE_RUNNING, simulation_time, id, n_cpus > 1 ? (int)(cpu-cpus) : TRACE_NO_CPU, table->serv_time_remaining[id]);
+        return;
+    }
+    transcript_long(transcript, simulation_time);
+    transcript_str(transcript, ",RUNNING,process_name=");
+    transcript_str(transcript, table->processes[id].name);
+    transcript_str(transcript, ",remaining_time=");
+    transcript_long(transcript, table->serv_time_remaining[id]);
+    if (n_cpus > 1){
+        transcript_str(transcript, ",cpu=");
+        transcript_long(transcript, (long)(cpu-cpus));
+    }
+    transcript_end_line(transcript);
+}
+
+/**
+ * Prints that process `id` of `table` is FINISHED, leaving `proc_remaining` processes waiting for memory or READY, to
+ * `transcript`, or records it in `trace` if it is not NULL.
+*/
+void print_finished(proc_table_t *table, proc_id_t id, int proc_remaining, long simulation_time, transcript_t *transcript, trace_t *trace){
+    if (trace != NULL){
+        trace_event(trace, TRACE_FINISHED, simulation_time, id, 0, proc_remaining);
+        return;
+    }
+    transcript_long(transcript, simulation_time);
+    transcript_str(transcript, ",FINISHED,process_name=");
+    transcript_str(transcript, table->processes[id].name);
+    transcript_str(transcript, ",proc_remaining=");
+    transcript_long(transcript, proc_remaining);
+    transcript_end_line(transcript);
+}
+
+/**
+ * Prints performance statistics: average turnaround time, time overhead (maximum and average), and makespan. With
+ * more than one of `cpus`, also prints the utilisation of each CPU, the fraction of the makespan it spent running
+ * processes, given that each busy cycle lasts one `quantum`. These are printed to `transcript` once, so they are
+ * formatted with transcript_printf(). If `trace` is not NULL, the values that would be printed are recorded in it
+ * instead.
+*/
+void print_performance_stats(long total_turnaround, long num_processes, double total_overhead, double max_overhead, long simulation_time, cpu_t *cpus, int n_cpus, int quantum, transcript_t *transcript, trace_t *trace){
+    double turnaround = ceil(total_turnaround/(double)num_processes);
+    double overhead_max = round(max_overhead*100)/100;
+    double overhead_mean = round((total_overhead/(double)num_processes)*100)/100;
+
+    if (trace != NULL){
+        trace_stat(trace, TRACE_TURNAROUND, 0, turnaround);
+        trace_stat(trace, TRACE_OVERHEAD_MAX, 0, overhead_max);
+        trace_stat(trace, TRACE_OVERHEAD_MEAN, 0, overhead_mean);
+        trace_event(trace, TRACE_MAKESPAN, simulation_time, 0, 0, simulation_time);
+    }
+    else {
+        transcript_printf(transcript, "Turnaround time %.0f\n", turnaround);
+        transcript_printf(transcript, "Time overhead %.2f %.2f\n", overhead_max, overhead_mean);
+        transcript_printf(transcript, "Makespan %ld\n", simulation_time);
+    }
+    for (int c = 0; n_cpus > 1 && c < n_cpus; c++){
+        double utilisation = simulation_time > 0 ? cpus[c].busy_cycles*(double)quantum/simulation_time : 0;
+        if (trace != NULL){
+            trace_stat(trace, TRACE_UTILISATION, c, round(utilisation*100)/100);
+        }
+        else {
+            transcript_printf(transcript, "CPU %d utilisation %.2f\n", c, round(utilisation*100)/100);
+        }
+    }
+}
+
+/**
+ * Prints the host core of each of `cpus`, and the number and mean latency of the handshakes with its real processes, 
+ * from sending the time to reading the echo. These are printed to STDERR, as they vary from run to run.
+*/
+void print_handshake_stats(cpu_t *cpus, int n_cpus, transcript_t *transcript){
+    // Keep the transcript ahead of the statistics when both go to the same place
+    if (transcript != NULL){
+        transcript_flush(transcript);
+    }
+    for (int c = 0; c < n_cpus; c++){
+        double mean_ns = cpus[c].handshakes > 0 ? cpus[c].handshake_ns/(double)cpus[c].handshakes : 0;
+        fprintf(stderr, "CPU %d core %d handshakes %ld mean %.0f ns\n", c, cpus[c].core, cpus[c].handshakes, mean_ns);
+    }
 }
 
 /**
@@ -335,68 +981,78 @@ void to_byte_array(long value, uint8_t *bytes){
 }
 
 /**
- * Creates a real process using fork() and execv(). Uses pipe() and dup2() to redirect STDIN and STDOUT to and from 
- * "process". Sends the 32-bit `simulation_time` to STDIN of "process", and reads 1 byte from STDOUT of "process" to
- * make sure that a similar least significant byte was sent.
+ * Creates a real process with spawn_process(), or with spawn_channel_process() if `shared`, or takes a worker from 
+ * `pool` unless it is NULL, which saves spawning, reaping and making pipes for every process. Unless `core` is 
+ * `NO_CORE`, the real process is then pinned to that host core, before it is sent anything. Sends the 32-bit 
+ * `simulation_time` to STDIN of "process", or as a START message on its channel, whose echo is read by 
+ * await_process().
 */
-void create_process(process_t *running_process, long simulation_time){
-    char *args[] = {"process", running_process->name, NULL};
-    uint8_t read_byte;
+void create_process(process_t *running_process, long simulation_time, int core, worker_pool_t *pool, int shared){
+    char *args[] = {PROCESS_PATH, running_process->name, NULL};
+    char *channel_args[] = {PROCESS_PATH, CHANNEL_OPTION, running_process->name, NULL};
     uint8_t byte_array[N_BYTES];
-    
-    /* Creates two pipes. The idea of using two pipes for two-way communication between parent and child process was 
-    referenced from tutorialspoint. Inter Process Communication. 
-    https://www.tutorialspoint.com/inter_process_communication/inter_process_communication_pipes.htm.
-    Accessed on 15/4/2023, and modified to work with process_t struct for this project. */
-    if (pipe(running_process->fd_1) == -1){
-        perror("pipe");
-        exit(EXIT_FAILURE);
+
+    if (shared){
+        spawn_channel_process(running_process, channel_args);
     }
-    if (pipe(running_process->fd_2) == -1){
-        perror("pipe");
-        exit(EXIT_FAILURE);
+    else if (pool != NULL){
+        assign_worker(pool, running_process);
+    }
+    else {
+        spawn_process(running_process, args);
     }
 
-    // Create child process
-    pid_t pid = fork();
-
-    if (pid == 0){     
-        // Close the write side of `fd_1`, and the read side of `fd_2`
-        close(running_process->fd_1[1]);
-        close(running_process->fd_2[0]);
-        // Redirect STDIN and STDOUT to and from "process"
-        dup2(running_process->fd_1[0], STDIN_FILENO);
-        dup2(running_process->fd_2[1], STDOUT_FILENO);
-        execv("process", args);
-        exit(0);
-    }
-    if (pid > 0){
-        running_process->pid = pid;
-        // Close the read side of `fd_1`, and the write side of `fd_2`
-        close(running_process->fd_1[0]);
-        close(running_process->fd_2[1]);
-        to_byte_array(simulation_time, byte_array);
-        // Write `simulation_time` to "process", and read 1 byte from the STDOUT of "process"
-        write(running_process->fd_1[1], byte_array, N_BYTES);
-        read(running_process->fd_2[0], &read_byte, sizeof(read_byte));
-        if (read_byte != byte_array[N_BYTES-1]){
-            perror("incorrect byte");
+    if (core != NO_CORE){
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        if (sched_setaffinity(running_process->pid, sizeof(set), &set) == -1){
+            perror("sched_setaffinity");
         }
     }
+
+    to_byte_array(simulation_time, byte_array);
+    // Write `simulation_time` to "process"
+    if (running_process->channel != NULL){
+        channel_send(running_process->channel, CHANNEL_START, byte_array);
+    }
+    else {
+        write(running_process->fd_1[1], byte_array, N_BYTES);
+    }
 }
 
 /**
  * Resumes a real process by first sending the `simulation_time` to STDIN of "process", then sending a SIGCONT signal 
- * to "process". Reads 1 byte from STDOUT of "process" to make sure that a similar least significant byte was sent.
+ * to "process", or by sending both as a CONTINUE message on its channel. Its echo is read by await_process().
 */
 void resume_process(process_t *running_process, long simulation_time){
-    uint8_t read_byte;
     uint8_t byte_array[N_BYTES];
     to_byte_array(simulation_time, byte_array);
 
+    if (running_process->channel != NULL){
+        channel_send(running_process->channel, CHANNEL_CONTINUE, byte_array);
+        return;
+    }
     write(running_process->fd_1[1], byte_array, N_BYTES);
-    kill(running_process->pid, SIGCONT);
-    read(running_process->fd_2[0], &read_byte, sizeof(read_byte));
+    signal_process(running_process, SIGCONT);
+}
+
+/**
+ * Reads 1 byte from STDOUT of a real process that has been created or resumed, or from its channel once it has 
+ * handled the message, to make sure that a similar least significant byte of `simulation_time` was sent.
+*/
+void await_process(process_t *running_process, long simulation_time){
+    uint8_t read_byte;
+    uint8_t byte_array[N_BYTES];
+    to_byte_array(simulation_time, byte_array);
+
+    if (running_process->channel != NULL){
+        channel_wait(running_process->channel);
+        read_byte = running_process->channel->echo;
+    }
+    else {
+        read(running_process->fd_2[0], &read_byte, sizeof(read_byte));
+    }
     if (read_byte != byte_array[N_BYTES-1]){
         perror("incorrect byte");
     }
@@ -404,40 +1060,98 @@ void resume_process(process_t *running_process, long simulation_time){
 
 /**
  * Suspends a real process by first sending the `simulation_time` to STDIN of "process", then sending a SIGTSTP signal 
- * to "process".
+ * to "process", or by sending both as a STOP message on its channel. Its stop is waited for by await_stop().
 */
 void suspend_process(process_t *running_process, long simulation_time){
     uint8_t byte_array[N_BYTES];
-    int status;
 
     to_byte_array(simulation_time, byte_array);
+    if (running_process->channel != NULL){
+        channel_send(running_process->channel, CHANNEL_STOP, byte_array);
+        return;
+    }
     write(running_process->fd_1[1], byte_array, N_BYTES);
-    kill(running_process->pid, SIGTSTP);
+    signal_process(running_process, SIGTSTP);
+}
 
-    // Wait for the process to enter a stopped state
+/**
+ * Waits for a real process that has been sent SIGTSTP to enter a stopped state. A process with a channel is not 
+ * stopped by a signal, but sleeps on its channel once it has handled the STOP message.
+*/
+void await_stop(process_t *process){
+    int status;
+    if (process->channel != NULL){
+        channel_wait(process->channel);
+        return;
+    }
     do {
-        waitpid(running_process->pid, &status, WUNTRACED);
+        waitpid(process->pid, &status, WUNTRACED);
     }
     while (!WIFSTOPPED(status));
 }
 
 /**
  * Terminates a real process by first sending the `simulation_time` to STDIN of "process", then sending a SIGTERM signal 
- * to "process". Reads a 64-byte string from STDOUT of "process" to be included in the execution transcript.
+ * to "process". Reads a 64-byte string from STDOUT of "process" to be included in the execution transcript. A worker
+ * from `pool` does not exit, and is returned to `pool` once it has printed the string. With an event `loop`, the exit
+ * is seen through the pidfd of the process, which is then no longer watched. A process with a channel is sent both
+ * as a TERM message, and writes the string back on the channel.
 */
-void terminate_process(process_t *process, long simulation_time){
+void terminate_process(proc_table_t *table, proc_id_t id, long simulation_time, worker_pool_t *pool, event_loop_t *loop, transcript_t *transcript, trace_t *trace){
+    process_t *process = &table->processes[id];
     uint8_t byte_array[N_BYTES];
     uint8_t sha_array[SHA_LEN];
     int status;
 
     to_byte_array(simulation_time, byte_array);
+    if (process->channel != NULL){
+        channel_send(process->channel, CHANNEL_TERM, byte_array);
+        channel_wait(process->channel);
+        waitpid(process->pid, &status, 0);
+        print_finished_process(table, id, process->channel->sha, simulation_time, transcript, trace);
+        free_channel(process->channel);
+        process->channel = NULL;
+        return;
+    }
     write(process->fd_1[1], byte_array, N_BYTES);
     // Wait for the child process to be successfully terminated
-    if (kill(process->pid, SIGTERM) == 0){
+    if (signal_process(process, SIGTERM) == 0 && pool == NULL && loop == NULL){
         waitpid(process->pid, &status, 0);
     }
     
     read(process->fd_2[0], sha_array, SHA_LEN);
     sha_array[SHA_LEN-1] = '\0';
-    printf("%ld,FINISHED-PROCESS,process_name=%s,sha=%s\n", simulation_time, process->name, sha_array);
-}
\ No newline at end of file
+    print_finished_process(table, id, (char *)sha_array, simulation_time, transcript, trace);
+
+    if (loop != NULL){
+        if (pool == NULL){
+            await_event(loop, id, AWAIT_EXIT);
+            run_event_loop(loop);
+        }
+        unwatch_process(loop, id);
+    }
+    if (pool != NULL){
+        release_worker(pool, process);
+    }
+    else {
+        close(process->fd_1[1]);
+        close(process->fd_2[0]);
+    }
+}
+
+/**
+ * Prints that process `id` of `table` has FINISHED-PROCESS at `simulation_time`, with the `sha` of its transcript, to
+ * `transcript`, or records it in `trace` if it is not NULL.
+*/
+void print_finished_process(proc_table_t *table, proc_id_t id, const char *sha, long simulation_time, transcript_t *transcript, trace_t *trace){
+    if (trace != NULL){
+        trace_sha(trace, simulation_time, id, sha);
+        return;
+    }
+    transcript_long(transcript, simulation_time);
+    transcript_str(transcript, ",FINISHED-PROCESS,process_name=");
+    transcript_str(transcript, table->processes[id].name);
+    transcript_str(transcript, ",sha=");
+    transcript_str(transcript, sha);
+    transcript_end_line(transcript);
+}
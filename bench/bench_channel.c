@@ -0,0 +1,132 @@
+/**
+ * Benchmarks the round-trip latency of resuming a running "process" and reading its echo, over the pipes and 
+ * signals used by default against a shared memory channel. Each run spawns one "process", which must be built in the
+ * current directory, starts it, resumes it `N_ROUND_TRIPS` times with an increasing time, and terminates it, checking
+ * every echo and that both transports give the same sha. The child is pinned to core 1 and this process to core 0, 
+ * wrapping around the cores available, so on a machine with one core the numbers include time-slicing. Prints one 
+ * line per transport:
+ * transport,round_trips,ns_per_round_trip,sha
+*/
+#define _GNU_SOURCE
+#include <time.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include "../worker.h"
+#include "../channel.h"
+
+// The number of times the process is resumed per run
+#define N_ROUND_TRIPS 100000
+// The name the process is started with
+#define BENCH_NAME "P1"
+// The length of the sha read back on termination, including the newline or null byte after it
+#define SHA_LEN 65
+
+// Transports benchmarked
+#define PIPES 0
+#define CHANNEL 1
+
+// Returns the current monotonic time in nanoseconds
+static long long now_ns(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1000000000LL + ts.tv_nsec;
+}
+
+// Pins process `pid`, or this process if it is 0, to core `core`, wrapping around the cores available
+static void pin(pid_t pid, int core){
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core%sysconf(_SC_NPROCESSORS_ONLN), &set);
+    sched_setaffinity(pid, sizeof(set), &set);
+}
+
+// Converts `value` to 4 big-endian `bytes`
+static void to_bytes(uint32_t value, uint8_t bytes[CHANNEL_TIME_BYTES]){
+    bytes[0] = (uint8_t)(value >> 24);
+    bytes[1] = (uint8_t)(value >> 16);
+    bytes[2] = (uint8_t)(value >> 8);
+    bytes[3] = (uint8_t)value;
+}
+
+/**
+ * Sends message `op` with `time` to `process` over `transport`, and waits for its echo if it has one. Exits if the
+ * echo is wrong.
+*/
+static void round_trip(process_t *process, int transport, int op, uint32_t time){
+    uint8_t bytes[CHANNEL_TIME_BYTES];
+    uint8_t echo;
+    to_bytes(time, bytes);
+
+    if (transport == CHANNEL){
+        channel_send(process->channel, op, bytes);
+        channel_wait(process->channel);
+        echo = process->channel->echo;
+    }
+    else {
+        write(process->fd_1[1], bytes, CHANNEL_TIME_BYTES);
+        if (op == CHANNEL_CONTINUE){
+            kill(process->pid, SIGCONT);
+        }
+        read(process->fd_2[0], &echo, sizeof(echo));
+    }
+    if (echo != bytes[CHANNEL_TIME_BYTES-1]){
+        fprintf(stderr, "Error: incorrect echo\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Terminates `process` over `transport`, and copies the sha it writes back into `sha`.
+*/
+static void terminate(process_t *process, int transport, uint32_t time, char sha[SHA_LEN]){
+    uint8_t bytes[CHANNEL_TIME_BYTES];
+    to_bytes(time, bytes);
+
+    if (transport == CHANNEL){
+        channel_send(process->channel, CHANNEL_TERM, bytes);
+        channel_wait(process->channel);
+        memcpy(sha, process->channel->sha, SHA_LEN);
+        free_channel(process->channel);
+    }
+    else {
+        write(process->fd_1[1], bytes, CHANNEL_TIME_BYTES);
+        kill(process->pid, SIGTERM);
+        read(process->fd_2[0], sha, SHA_LEN);
+        close(process->fd_1[1]);
+        close(process->fd_2[0]);
+    }
+    sha[SHA_LEN-1] = '\0';
+    waitpid(process->pid, NULL, 0);
+}
+
+int main(){
+    char *args[] = {PROCESS_PATH, BENCH_NAME, NULL};
+    char *channel_args[] = {PROCESS_PATH, CHANNEL_OPTION, BENCH_NAME, NULL};
+    char sha[SHA_LEN];
+
+    pin(0, 0);
+    printf("transport,round_trips,ns_per_round_trip,sha\n");
+    for (int transport = PIPES; transport <= CHANNEL; transport++){
+        process_t process;
+        process.channel = NULL;
+        if (transport == CHANNEL){
+            spawn_channel_process(&process, channel_args);
+        }
+        else {
+            spawn_process(&process, args);
+        }
+        pin(process.pid, 1);
+
+        uint32_t time = 0;
+        round_trip(&process, transport, CHANNEL_START, time);
+        long long start = now_ns();
+        for (int i = 0; i < N_ROUND_TRIPS; i++){
+            round_trip(&process, transport, CHANNEL_CONTINUE, ++time);
+        }
+        double ns = (now_ns() - start)/(double)N_ROUND_TRIPS;
+        terminate(&process, transport, ++time, sha);
+        printf("%s,%d,%.0f,%s\n", transport == CHANNEL ? "shm" : "pipe", N_ROUND_TRIPS, ns, sha);
+    }
+    return 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * Benchmarks allocation and deallocation for every memory allocation strategy on both memory backends, as the size of
+ * the simulated memory grows from 10^3 to 10^8 allocation units. Each run keeps a pool of live allocations whose sizes
+ * scale with memory, so the number of holes stays roughly constant and the timings show the cost of the memory size
+ * itself. Every strategy sees the same sequence of requests, and external fragmentation is reported at the end of 
+ * each run. Prints one line per (size, strategy, backend):
+ * size,strategy,backend,allocs,failed,frees,ns_per_alloc,ns_per_free,holes,fragmentation
+*/
+#include <time.h>
+#include "../memory.h"
+
+// The number of allocation or deallocation attempts per run
+#define N_OPS 100000
+// The maximum number of live allocations
+#define MAX_LIVE 4096
+// Allocation requests are at most 1/`REQ_SCALE` of the memory size
+#define REQ_SCALE 500
+// The smallest and largest memory sizes benchmarked
+#define MIN_BENCH_SIZE 1000
+#define MAX_BENCH_SIZE 100000000
+
+// A live allocation of `mem_req` units starting at `mem_addr`
+typedef struct allocation{
+    int mem_addr;
+    int mem_req;
+} allocation_t;
+
+// Returns the current monotonic time in nanoseconds
+static long long now_ns(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1000000000LL + ts.tv_nsec;
+}
+
+// The strategies benchmarked
+#define N_STRATEGIES 5
+static const char *strategies[N_STRATEGIES] = {BEST_FIT, WORST_FIT, FIRST_FIT, NEXT_FIT, BUDDY};
+
+/**
+ * Runs `N_OPS` random allocations and deallocations on a new memory of `size` units using `strategy` on `backend`,
+ * then prints the mean time of each and the fragmentation of the remaining free memory.
+*/
+static void bench(const char *strategy, int backend, int size){
+    static allocation_t live[MAX_LIVE];
+    int n_live = 0;
+    long allocs = 0, failed = 0, frees = 0;
+    long long alloc_ns = 0, free_ns = 0;
+    int max_req = size/REQ_SCALE > 0 ? size/REQ_SCALE : 1;
+    memory_t *memory = new_mem_array(find_mem_strategy(strategy, backend), size);
+    mem_stats_t stats;
+
+    srand(size);
+    for (int i = 0; i < N_OPS; i++){
+        if (n_live == MAX_LIVE || (n_live > 0 && rand()%2)){
+            int k = rand()%n_live;
+            long long start = now_ns();
+            deallocate(memory, live[k].mem_addr, live[k].mem_req);
+            free_ns += now_ns()-start;
+            frees++;
+            live[k] = live[--n_live];
+        }
+        else {
+            allocation_t *allocation = &live[n_live];
+            allocation->mem_req = 1+rand()%max_req;
+            long long start = now_ns();
+            int address = mem_allocate(memory, allocation->mem_req);
+            alloc_ns += now_ns()-start;
+            allocs++;
+            if (address != INIT_ADDR){
+                allocation->mem_addr = address;
+                n_live++;
+            }
+            else {
+                failed++;
+            }
+        }
+    }
+
+    mem_stats(memory, &stats);
+    printf("%d,%s,%s,%ld,%ld,%ld,%.1f,%.1f,%ld,%.3f\n", size, strategy, backend == MEM_BITMAP ? "bitmap" : "index",
+           allocs, failed, frees, alloc_ns/(double)allocs, frees > 0 ? free_ns/(double)frees : 0.0, stats.n_holes,
+           stats.free_units > 0 ? 1-stats.largest/(double)stats.free_units : 0.0);
+    fflush(stdout);
+    free_mem_array(memory);
+}
+
+int main(int argc, char *argv[]){
+    int max_size = argc > 1 ? atoi(argv[1]) : MAX_BENCH_SIZE;
+
+    printf("size,strategy,backend,allocs,failed,frees,ns_per_alloc,ns_per_free,holes,fragmentation\n");
+    for (long size = MIN_BENCH_SIZE; size <= max_size; size *= 10){
+        for (int i = 0; i < N_STRATEGIES; i++){
+            bench(strategies[i], MEM_INDEX, size);
+            bench(strategies[i], MEM_BITMAP, size);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+/**
+ * Benchmarks the throughput of the lock-free rings between threads pinned to different cores: `spsc_ring_t` with one
+ * producer, and `mpsc_ring_t` with one to `MAX_PRODUCERS` producers. For reference, a `circ_array_t` guarded by a 
+ * mutex is run with one producer. The consumer checks that every producer's ids arrive in order. Threads are pinned
+ * to cores 0, 1, 2, ... wrapping around the cores available, so on a machine with fewer cores the numbers include
+ * time-slicing. Prints one line per (ring, producers):
+ * ring,producers,capacity,ops,seconds,ops_per_sec
+*/
+#define _GNU_SOURCE
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "../ring.h"
+#include "../circular_array.h"
+
+// The number of ids passed through the ring per run
+#define N_OPS 10000000
+// The capacity of each ring
+#define RING_CAPACITY 1024
+// The most producers benchmarked with `mpsc_ring_t`
+#define MAX_PRODUCERS 3
+// Producer `p` sends ids `p`, `p+MAX_PRODUCERS`, `p+2*MAX_PRODUCERS`, ...
+#define ID(p, i) ((proc_id_t)((i)*MAX_PRODUCERS + (p)))
+
+// Rings benchmarked
+#define SPSC 0
+#define MPSC 1
+#define LOCKED 2
+
+// A ring shared by the producers and the consumer of a run, and how many ids each producer sends
+typedef struct run{
+    int kind;
+    int n_producers;
+    long per_producer;
+    spsc_ring_t *spsc;
+    mpsc_ring_t *mpsc;
+    circ_array_t *locked;
+    pthread_mutex_t lock;
+} run_t;
+
+// A producer thread, sending the ids of producer `p` on `run`
+typedef struct producer{
+    run_t *run;
+    int p;
+    pthread_t thread;
+} producer_t;
+
+// Returns the current monotonic time in nanoseconds
+static long long now_ns(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1000000000LL + ts.tv_nsec;
+}
+
+// Pins the calling thread to core `core`, wrapping around the cores available
+static void pin(int core){
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core%sysconf(_SC_NPROCESSORS_ONLN), &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+/**
+ * Sends every id of one producer, in order, spinning while the ring is full. The thread yields when it has to wait,
+ * so that runs still finish when threads share a core.
+*/
+static void *produce(void *arg){
+    producer_t *producer = (producer_t *)arg;
+    run_t *run = producer->run;
+    pin(1+producer->p);
+
+    for (long i = 0; i < run->per_producer; i++){
+        proc_id_t id = ID(producer->p, i);
+        if (run->kind == SPSC){
+            while (!spsc_push(run->spsc, id)){
+                sched_yield();
+            }
+        }
+        else if (run->kind == MPSC){
+            while (!mpsc_push(run->mpsc, id)){
+                sched_yield();
+            }
+        }
+        else {
+            while (1){
+                pthread_mutex_lock(&run->lock);
+                int full = run->locked->size == RING_CAPACITY;
+                if (!full){
+                    enqueue(run->locked, id);
+                }
+                pthread_mutex_unlock(&run->lock);
+                if (!full){
+                    break;
+                }
+                sched_yield();
+            }
+        }
+    }
+    return NULL;
+}
+
+// Pops one id from the ring of `run` on the consumer thread, or returns `NO_PROC` if it is empty
+static proc_id_t consume(run_t *run){
+    if (run->kind == SPSC){
+        return spsc_pop(run->spsc);
+    }
+    if (run->kind == MPSC){
+        return mpsc_pop(run->mpsc);
+    }
+    pthread_mutex_lock(&run->lock);
+    proc_id_t id = dequeue(run->locked);
+    pthread_mutex_unlock(&run->lock);
+    return id;
+}
+
+/**
+ * Passes `N_OPS` ids through a ring of `kind` from `n_producers` producer threads to this thread, pinned to core 0,
+ * and prints the throughput. Exits if any producer's ids arrive out of order or go missing.
+*/
+static void bench(int kind, int n_producers){
+    static const char *names[] = {"spsc", "mpsc", "locked"};
+    run_t run = {kind, n_producers, N_OPS/n_producers, NULL, NULL, NULL, PTHREAD_MUTEX_INITIALIZER};
+    producer_t producers[MAX_PRODUCERS];
+    long next[MAX_PRODUCERS] = {0};
+
+    run.spsc = new_spsc_ring(RING_CAPACITY);
+    run.mpsc = new_mpsc_ring(RING_CAPACITY);
+    run.locked = new_circular_array();
+    pin(0);
+
+    long long start = now_ns();
+    for (int p = 0; p < n_producers; p++){
+        producers[p].run = &run;
+        producers[p].p = p;
+        pthread_create(&producers[p].thread, NULL, produce, &producers[p]);
+    }
+    long total = run.per_producer*n_producers;
+    for (long received = 0; received < total; received++){
+        proc_id_t id;
+        while ((id = consume(&run)) == NO_PROC){
+            sched_yield();
+        }
+        int p = id%MAX_PRODUCERS;
+        if (p >= n_producers || id != ID(p, next[p])){
+            fprintf(stderr, "Error: %s ring delivered %u out of order\n", names[kind], id);
+            exit(EXIT_FAILURE);
+        }
+        next[p]++;
+    }
+    for (int p = 0; p < n_producers; p++){
+        pthread_join(producers[p].thread, NULL);
+    }
+    double seconds = (now_ns()-start)/1e9;
+
+    printf("%s,%d,%d,%ld,%.3f,%.0f\n", names[kind], n_producers, RING_CAPACITY, total, seconds, total/seconds);
+    fflush(stdout);
+    pthread_mutex_destroy(&run.lock);
+    free_array(run.locked);
+    free_mpsc_ring(run.mpsc);
+    free_spsc_ring(run.spsc);
+}
+
+int main(){
+    printf("ring,producers,capacity,ops,seconds,ops_per_sec\n");
+    bench(LOCKED, 1);
+    bench(SPSC, 1);
+    for (int n_producers = 1; n_producers <= MAX_PRODUCERS; n_producers++){
+        bench(MPSC, n_producers);
+    }
+    return 0;
+}
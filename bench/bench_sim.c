@@ -0,0 +1,225 @@
+/**
+ * Benchmarks the whole simulation, built without real processes as "allocate_sim", on synthetic workloads from 
+ * "gen_workload" of 10^3 processes up to a given number, by powers of ten. For each workload size and memory
+ * distribution, every scheduler, memory strategy and quantum is run on the same seeded workload, and timed from start
+ * to exit. Events are the lines of the transcript, and simulated cycles are the makespan over the quantum. The share
+ * of time spent in the memory allocator is the time of its allocate_memory and deallocate phases over the whole
+ * simulation, from the profile "allocate_sim" prints with --profile. Prints one line per run, labelled with a commit so that results can be compared between commits:
+ * commit,jobs,distribution,scheduler,memory,quantum,seconds,cycles,events,cycles_per_sec,events_per_sec,peak_rss_kb,alloc_share
+ * Usage: ./bench_sim <max-processes> <commit>
+*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+// The simulation and generator run
+#define SIM_PATH "./allocate_sim"
+#define GEN_PATH "./gen_workload"
+// The workload file each size is generated into, removed once it has been run
+#define WORKLOAD_PATH "bench_workload.bin"
+// The seed of every workload
+#define BENCH_SEED "42"
+// The smallest workload
+#define MIN_JOBS 1000
+// The number of bytes of the transcript read at a time, and kept from the end of it to find the makespan in
+#define READ_BLOCK (1 << 16)
+// The number of lines after the events, holding the performance statistics of a single CPU
+#define N_STATS_LINES 3
+// The number of bytes of the profile kept, which is printed to STDERR after the transcript
+#define PROFILE_SIZE 4096
+
+#define N_DISTRIBUTIONS 2
+static const char *distributions[N_DISTRIBUTIONS] = {"uniform", "bimodal"};
+#define N_SCHEDULERS 2
+static const char *schedulers[N_SCHEDULERS] = {"SJF", "RR"};
+#define N_MEMORIES 6
+static const char *memories[N_MEMORIES] = {"infinite", "best-fit", "first-fit", "next-fit", "worst-fit", "buddy"};
+#define N_QUANTA 2
+static const char *quanta[N_QUANTA] = {"1", "3"};
+
+/**
+ * What one run of the simulation took: `seconds` of wall time, the `makespan` and number of `events` in its 
+ * transcript, its peak resident set in KiB, and the share of its time spent in the memory allocator.
+*/
+typedef struct run{
+    double seconds;
+    long makespan;
+    long events;
+    long peak_rss_kb;
+    double alloc_share;
+} run_t;
+
+// Returns the current monotonic time in seconds
+static double now(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec/1e9;
+}
+
+/**
+ * Runs `args` to completion with its STDOUT redirected to `out_fd` unless it is -1, and returns its wait status. The
+ * resources it used are returned in `usage`.
+*/
+static int run_child(char *const args[], int out_fd, struct rusage *usage){
+    pid_t pid = fork();
+    if (pid == -1){
+        perror("fork");
+        exit(EXIT_FAILURE);
+    }
+    if (pid == 0){
+        if (out_fd != -1){
+            dup2(out_fd, STDOUT_FILENO);
+            close(out_fd);
+        }
+        execv(args[0], args);
+        perror(args[0]);
+        _exit(EXIT_FAILURE);
+    }
+    if (out_fd != -1){
+        close(out_fd);
+    }
+    int status;
+    wait4(pid, &status, 0, usage);
+    return status;
+}
+
+/**
+ * Generates the workload of `jobs` processes with `distribution` memory requirements into `WORKLOAD_PATH`.
+*/
+static void generate(long jobs, const char *distribution){
+    char n[32];
+    snprintf(n, sizeof(n), "%ld", jobs);
+    char *args[] = {GEN_PATH, "-n", n, "-s", BENCH_SEED, "-d", (char *)distribution, "-b", WORKLOAD_PATH, NULL};
+    struct rusage usage;
+    if (run_child(args, -1, &usage) != 0){
+        fprintf(stderr, "Error: could not generate a workload\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Returns the total time in ms of `probe` in `profile`, or 0 if it was never hit.
+*/
+static double profile_ms(const char *profile, const char *probe){
+    char label[64];
+    snprintf(label, sizeof(label), "Profile %s calls ", probe);
+    const char *line = strstr(profile, label);
+    if (line == NULL){
+        return 0;
+    }
+    const char *total = strstr(line, " total ");
+    return total == NULL ? 0 : strtod(total+strlen(" total "), NULL);
+}
+
+/**
+ * Runs the simulation on `WORKLOAD_PATH` with `scheduler`, `memory` and `quantum`, counting the lines of its 
+ * transcript as it is read, and finding the makespan in the last of them. Its profile is read from STDERR once the
+ * transcript is over, as it fits in the pipe. Fills in `run`.
+*/
+static void simulate(const char *scheduler, const char *memory, const char *quantum, run_t *run){
+    char *args[] = {SIM_PATH, "-f", WORKLOAD_PATH, "-s", (char *)scheduler, "-m", (char *)memory, "-q", (char *)quantum, "--profile", NULL};
+    static char buffer[2*READ_BLOCK+1];
+    static char profile[PROFILE_SIZE+1];
+    int fds[2], err_fds[2];
+    if (pipe(fds) == -1 || pipe(err_fds) == -1){
+        perror("pipe");
+        exit(EXIT_FAILURE);
+    }
+
+    double start = now();
+    pid_t pid = fork();
+    if (pid == -1){
+        perror("fork");
+        exit(EXIT_FAILURE);
+    }
+    if (pid == 0){
+        close(fds[0]);
+        close(err_fds[0]);
+        dup2(fds[1], STDOUT_FILENO);
+        dup2(err_fds[1], STDERR_FILENO);
+        close(fds[1]);
+        close(err_fds[1]);
+        execv(args[0], args);
+        perror(args[0]);
+        _exit(EXIT_FAILURE);
+    }
+    close(fds[1]);
+    close(err_fds[1]);
+
+    // Keep the previous block along with the current one, so the statistics are whole however the reads split them
+    long lines = 0;
+    size_t kept = 0;
+    ssize_t n_read;
+    while ((n_read = read(fds[0], buffer+kept, READ_BLOCK)) > 0){
+        for (char *p = buffer+kept; (p = memchr(p, '\n', buffer+kept+n_read-p)) != NULL; p++){
+            lines++;
+        }
+        kept += n_read;
+        if (kept > READ_BLOCK){
+            memmove(buffer, buffer+kept-READ_BLOCK, READ_BLOCK);
+            kept = READ_BLOCK;
+        }
+    }
+    close(fds[0]);
+
+    size_t profile_size = 0;
+    while (profile_size < PROFILE_SIZE 
+        && (n_read = read(err_fds[0], profile+profile_size, PROFILE_SIZE-profile_size)) > 0){
+        profile_size += n_read;
+    }
+    profile[profile_size] = '\0';
+    close(err_fds[0]);
+
+    int status;
+    struct rusage usage;
+    wait4(pid, &status, 0, &usage);
+    run->seconds = now()-start;
+    buffer[kept] = '\0';
+    char *makespan = strstr(buffer, "Makespan ");
+    if (status != 0 || makespan == NULL){
+        fprintf(stderr, "Error: %s -s %s -m %s -q %s failed\n", SIM_PATH, scheduler, memory, quantum);
+        exit(EXIT_FAILURE);
+    }
+    run->makespan = strtol(makespan+strlen("Makespan "), NULL, 10);
+    run->events = lines-N_STATS_LINES;
+    run->peak_rss_kb = usage.ru_maxrss;
+    double simulation_ms = profile_ms(profile, "simulation");
+    double alloc_ms = profile_ms(profile, "allocate_memory")+profile_ms(profile, "deallocate");
+    run->alloc_share = simulation_ms > 0 ? alloc_ms/simulation_ms : 0;
+}
+
+int main(int argc, char *argv[]){
+    if (argc != 3 || atol(argv[1]) < MIN_JOBS){
+        fprintf(stderr, "Usage: %s <max-processes> <commit>\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    long max_jobs = atol(argv[1]);
+    const char *commit = argv[2];
+
+    printf("commit,jobs,distribution,scheduler,memory,quantum,seconds,cycles,events,cycles_per_sec,events_per_sec,peak_rss_kb,alloc_share\n");
+    for (long jobs = MIN_JOBS; jobs <= max_jobs; jobs *= 10){
+        for (int d = 0; d < N_DISTRIBUTIONS; d++){
+            generate(jobs, distributions[d]);
+            for (int s = 0; s < N_SCHEDULERS; s++){
+                for (int q = 0; q < N_QUANTA; q++){
+                    for (int m = 0; m < N_MEMORIES; m++){
+                        run_t run;
+                        simulate(schedulers[s], memories[m], quanta[q], &run);
+                        long cycles = run.makespan/atol(quanta[q]);
+                        printf("%s,%ld,%s,%s,%s,%s,%.3f,%ld,%ld,%.0f,%.0f,%ld,%.3f\n", commit, jobs, distributions[d], 
+                            schedulers[s], memories[m], quanta[q], run.seconds, cycles, run.events, 
+                            cycles/run.seconds, run.events/run.seconds, run.peak_rss_kb, run.alloc_share);
+                        fflush(stdout);
+                    }
+                }
+            }
+            unlink(WORKLOAD_PATH);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+/**
+ * Benchmarks the latency of creating a child the way create_process() does, with its STDIN and STDOUT redirected to
+ * and from a pair of pipes, using fork() and execv() against posix_spawn(). The parent first allocates and touches a
+ * heap of each size in `HEAP_MB`, as the simulation's heap grows with the trace, and fork() has to copy the page
+ * tables that map it. Each child runs `SPAWN_PATH`, which exits at once, and is waited for. Prints one line per
+ * (method, heap size):
+ * method,heap_mb,spawns,us_per_spawn
+*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// The program run by each child
+#define SPAWN_PATH "/bin/true"
+// The number of children created per (method, heap size)
+#define N_SPAWNS 200
+// The sizes of the parent's heap, in MiB
+#define N_HEAPS 5
+static const int HEAP_MB[N_HEAPS] = {0, 16, 64, 256, 1024};
+
+// Methods benchmarked
+#define FORK 0
+#define SPAWN 1
+
+// Returns the current monotonic time in nanoseconds
+static long long now_ns(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Creates one child running `SPAWN_PATH` with `method`, with its STDIN and STDOUT redirected to and from new pipes,
+ * then closes the pipes and waits for the child to exit.
+*/
+static void spawn_one(int method){
+    char *args[] = {SPAWN_PATH, NULL};
+    int fd_1[2], fd_2[2];
+    pid_t pid;
+
+    if (pipe2(fd_1, O_CLOEXEC) == -1 || pipe2(fd_2, O_CLOEXEC) == -1){
+        perror("pipe2");
+        exit(EXIT_FAILURE);
+    }
+
+    if (method == FORK){
+        pid = fork();
+        if (pid == 0){
+            dup2(fd_1[0], STDIN_FILENO);
+            dup2(fd_2[1], STDOUT_FILENO);
+            execv(SPAWN_PATH, args);
+            _exit(EXIT_FAILURE);
+        }
+        if (pid == -1){
+            perror("fork");
+            exit(EXIT_FAILURE);
+        }
+    }
+    else {
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, fd_1[0], STDIN_FILENO);
+        posix_spawn_file_actions_adddup2(&actions, fd_2[1], STDOUT_FILENO);
+        if (posix_spawn(&pid, SPAWN_PATH, &actions, NULL, args, environ) != 0){
+            perror("posix_spawn");
+            exit(EXIT_FAILURE);
+        }
+        posix_spawn_file_actions_destroy(&actions);
+    }
+
+    close(fd_1[0]);
+    close(fd_1[1]);
+    close(fd_2[0]);
+    close(fd_2[1]);
+    waitpid(pid, NULL, 0);
+}
+
+int main(){
+    printf("method,heap_mb,spawns,us_per_spawn\n");
+
+    for (int h = 0; h < N_HEAPS; h++){
+        // Touch every page, so that each one is mapped and fork() has to copy its page table entry
+        size_t heap_size = (size_t)HEAP_MB[h] << 20;
+        char *heap = NULL;
+        if (heap_size > 0){
+            heap = (char *)malloc(heap_size);
+            assert(heap);
+            memset(heap, 1, heap_size);
+        }
+
+        for (int method = FORK; method <= SPAWN; method++){
+            long long start = now_ns();
+            for (int i = 0; i < N_SPAWNS; i++){
+                spawn_one(method);
+            }
+            double us = (now_ns() - start)/1000.0/N_SPAWNS;
+            printf("%s,%d,%d,%.1f\n", method == FORK ? "fork" : "posix_spawn", HEAP_MB[h], N_SPAWNS, us);
+        }
+        free(heap);
+    }
+    return 0;
+}
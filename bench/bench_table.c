@@ -0,0 +1,142 @@
+/**
+ * Benchmarks allocating and freeing processes with malloc(), as whole records holding every field, against the process
+ * table, which keeps each hot field in its own column, as the number of live processes grows from 10^3 to 10^6. Each run fills a pool of live processes and churns through it like the
+ * simulation does, freeing processes when they finish, in a random order, and allocating new ones as they arrive. 
+ * Both allocators see the same sequence of operations. After the churn, the remaining service time of every live 
+ * process is read, as a scan of a queue would, to show the cost of where the processes ended up in memory. Prints one
+ * line per (live, allocator):
+ * live,allocator,allocs,frees,system_allocs,ns_per_op,ns_per_visit
+*/
+#include <time.h>
+#include "../proc_table.h"
+
+// The number of processes freed and replaced per run
+#define N_OPS 4000000
+// The smallest and largest numbers of live processes benchmarked
+#define MIN_LIVE 1000
+#define MAX_LIVE 1000000
+// The number of times the live processes are visited after the churn
+#define N_VISITS 10
+
+// A process as one record holding every field, hot and cold, as they were kept before the process table
+typedef struct record{
+    unsigned int time_arr;
+    char name[MAX_NAME_LEN];
+    long serv_time;
+    int mem_req;
+    long serv_time_remaining;
+    int mem_addr;
+    int pid;
+    int fd_1[READ_WRITE], fd_2[READ_WRITE];
+} record_t;
+
+// Returns the current monotonic time in nanoseconds
+static long long now_ns(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Fills a pool of `max_live` processes, then churns through it for `N_OPS` operations, each freeing a random live 
+ * process and allocating its replacement. Uses the process table if `use_table` is set and malloc() otherwise. Then 
+ * prints the mean time per allocation or free, the number of times memory was requested from malloc() or realloc(),
+ * and the mean time to visit a live process.
+*/
+static void bench(int max_live, int use_table){
+    record_t **live = (record_t **)malloc(sizeof(record_t *)*max_live);
+    proc_id_t *live_ids = (proc_id_t *)malloc(sizeof(proc_id_t)*max_live);
+    assert(live && live_ids);
+    int n_live = max_live;
+    long allocs = 0, frees = 0;
+    long grows = 0;
+    proc_table_t *table = new_proc_table();
+
+    // Draw the processes to free up front, so that rand() is not timed
+    int *victims = (int *)malloc(sizeof(int)*N_OPS);
+    assert(victims);
+    srand(max_live);
+    for (long i = 0; i < N_OPS; i++){
+        victims[i] = rand()%max_live;
+    }
+
+    long long start = now_ns();
+    for (int k = 0; k < max_live; k++){
+        if (use_table){
+            uint32_t capacity = table->capacity;
+            live_ids[k] = new_process(table);
+            table->serv_time_remaining[live_ids[k]] = k;
+            grows += table->capacity != capacity;
+        }
+        else {
+            live[k] = (record_t *)malloc(sizeof(record_t));
+            assert(live[k]);
+            live[k]->serv_time_remaining = k;
+        }
+        allocs++;
+    }
+    for (long i = 0; i < N_OPS; i++){
+        int k = victims[i];
+        if (use_table){
+            free_process(table, live_ids[k]);
+            live_ids[k] = new_process(table);
+            table->serv_time_remaining[live_ids[k]] = i;
+        }
+        else {
+            free(live[k]);
+            live[k] = (record_t *)malloc(sizeof(record_t));
+            assert(live[k]);
+            live[k]->serv_time_remaining = i;
+        }
+        frees++;
+        allocs++;
+    }
+    long long churn_ns = now_ns()-start;
+
+    // Visit every live process, as scanning a queue of them would
+    long sum = 0;
+    start = now_ns();
+    for (int v = 0; v < N_VISITS; v++){
+        if (use_table){
+            for (int k = 0; k < n_live; k++){
+                sum += table->serv_time_remaining[live_ids[k]];
+            }
+        }
+        else {
+            for (int k = 0; k < n_live; k++){
+                sum += live[k]->serv_time_remaining;
+            }
+        }
+    }
+    long long visit_ns = now_ns()-start;
+
+    printf("%d,%s,%ld,%ld,%ld,%.1f,%.2f\n", max_live, use_table ? "table" : "malloc", allocs, frees, 
+           use_table ? grows : allocs, churn_ns/(double)(allocs+frees), 
+           n_live > 0 ? visit_ns/(double)(N_VISITS*(long)n_live) : 0.0);
+    fflush(stdout);
+
+    if (!use_table){
+        for (int k = 0; k < n_live; k++){
+            free(live[k]);
+        }
+    }
+    free_proc_table(table);
+    free(victims);
+    free(live_ids);
+    free(live);
+    // Keeps the visits from being optimised away
+    if (sum == -1){
+        printf("\n");
+    }
+}
+
+int main(int argc, char *argv[]){
+    int max_live = argc > 1 ? atoi(argv[1]) : MAX_LIVE;
+
+    printf("live,allocator,allocs,frees,system_allocs,ns_per_op,ns_per_visit\n");
+    for (int live = MIN_LIVE; live <= max_live; live *= 10){
+        bench(live, 0);
+        bench(live, 1);
+    }
+    return 0;
+}
@@ -0,0 +1,232 @@
+/**
+ * Generates a synthetic input file for "allocate" from a seed, so that the same workload can be rebuilt anywhere.
+ * Arrivals are a Poisson process of `-r` processes per unit of time, service times are heavy-tailed, drawn from a 
+ * Pareto distribution capped at `MAX_SERV_TIME`, and memory requirements are uniform up to a quarter of the `-M` 
+ * units of memory, or bimodal: mostly small, with some large. Processes are named "J" followed by their number in 
+ * base 36, which fits in `MAX_NAME_LEN` for as many processes as a binary workload can name.
+ * Usage: ./gen_workload -n <processes> [-s seed] [-r rate] [-d uniform|bimodal] [-M memory] [-b] <output>
+ * With -b, the output is written straight into a binary workload, the layout "convert_workload" writes, so large
+ * workloads never go through text.
+*/
+#define _GNU_SOURCE
+#include <math.h>
+#include <getopt.h>
+#include "../workload.h"
+
+// The default seed, arrival rate, and memory size, which matches the simulation's default
+#define DEFAULT_SEED 1
+#define DEFAULT_RATE 0.2
+#define DEFAULT_MEM_SIZE 2048
+// The shape of the Pareto distribution of service times, and the longest service time drawn
+#define PARETO_ALPHA 1.5
+#define MAX_SERV_TIME 10000
+// Bimodal memory requirements are large with probability 1/`LARGE_ODDS`, and small ones are at most 1/`SMALL_SCALE`
+// of the largest
+#define LARGE_ODDS 5
+#define SMALL_SCALE 16
+
+// Memory requirement distributions
+#define UNIFORM "uniform"
+#define BIMODAL "bimodal"
+
+/**
+ * Returns the next number of the splitmix64 generator with state `*state`, which is the same on every platform.
+*/
+static uint64_t next_random(uint64_t *state){
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Returns a uniform random double in (0, 1] from the generator with state `*state`.
+*/
+static double uniform(uint64_t *state){
+    return ((next_random(state) >> 11) + 1) * (1.0/9007199254740992.0);
+}
+
+/**
+ * Returns a uniform random integer in [`low`, `high`] from the generator with state `*state`.
+*/
+static long uniform_int(uint64_t *state, long low, long high){
+    return low + (long)(next_random(state) % (uint64_t)(high-low+1));
+}
+
+/**
+ * Writes the name of process `i`, "J" followed by `i` in base 36, into `name`, and returns its length.
+*/
+static int job_name(long i, char name[MAX_NAME_LEN]){
+    static const char digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+    char reversed[MAX_NAME_LEN];
+    int n = 0;
+    do {
+        reversed[n++] = digits[i%36];
+        i /= 36;
+    } while (i > 0);
+    name[0] = 'J';
+    for (int k = 0; k < n; k++){
+        name[k+1] = reversed[n-1-k];
+    }
+    name[n+1] = '\0';
+    return n+1;
+}
+
+/**
+ * The generator of a workload: its random `state`, the mean number of arrivals per unit of time `rate`, whether 
+ * memory requirements are `bimodal`, the largest memory requirement `max_req`, and the `time` of the last arrival.
+*/
+typedef struct generator{
+    uint64_t state;
+    double rate;
+    int bimodal;
+    int max_req;
+    double time;
+} generator_t;
+
+/**
+ * Draws the next process from `gen` into `arrival`, apart from its name. Inter-arrival times are exponential, so 
+ * arrivals are a Poisson process, and arrival times are rounded down to whole units.
+*/
+static void next_arrival(generator_t *gen, arrival_t *arrival){
+    gen->time += -log(uniform(&gen->state))/gen->rate;
+    double serv_time = ceil(pow(uniform(&gen->state), -1.0/PARETO_ALPHA));
+    arrival->time_arr = gen->time < UINT_MAX ? (unsigned int)gen->time : UINT_MAX;
+    arrival->serv_time = serv_time < MAX_SERV_TIME ? (long)serv_time : MAX_SERV_TIME;
+    if (gen->bimodal && uniform_int(&gen->state, 1, LARGE_ODDS) == 1){
+        arrival->mem_req = (int)uniform_int(&gen->state, gen->max_req/2 > 0 ? gen->max_req/2 : 1, gen->max_req);
+    }
+    else if (gen->bimodal){
+        arrival->mem_req = (int)uniform_int(&gen->state, 1, gen->max_req/SMALL_SCALE > 0 ? gen->max_req/SMALL_SCALE : 1);
+    }
+    else {
+        arrival->mem_req = (int)uniform_int(&gen->state, 1, gen->max_req);
+    }
+}
+
+/**
+ * Writes `n_jobs` processes drawn from `gen` to `out` as text, one line each.
+*/
+static void write_text(FILE *out, generator_t *gen, long n_jobs){
+    arrival_t arrival;
+    for (long i = 0; i < n_jobs; i++){
+        next_arrival(gen, &arrival);
+        job_name(i, arrival.name);
+        fprintf(out, "%u %s %ld %d\n", arrival.time_arr, arrival.name, arrival.serv_time, arrival.mem_req);
+    }
+}
+
+/**
+ * Writes `n_jobs` processes drawn from `gen` to the file `fd` as a binary workload. The file is sized up front and
+ * mapped, and every column is filled in in one pass. Each process has its own name, so name `i` is process `i`'s.
+*/
+static void write_binary(int fd, generator_t *gen, long n_jobs){
+    workload_header_t header;
+    workload_layout_t layout;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, WORKLOAD_MAGIC, sizeof(header.magic));
+    header.version = WORKLOAD_VERSION;
+    header.n_processes = n_jobs;
+    header.n_names = n_jobs;
+    // Names are at most `MAX_NAME_LEN`-1 bytes, and the file is cut down to the bytes used at the end
+    header.string_bytes = (uint64_t)n_jobs*(MAX_NAME_LEN-1);
+    workload_layout(&header, &layout);
+    if (ftruncate(fd, layout.bytes) == -1){
+        perror("ftruncate");
+        exit(EXIT_FAILURE);
+    }
+    char *data = mmap(NULL, layout.bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED){
+        perror("mmap");
+        exit(EXIT_FAILURE);
+    }
+
+    uint32_t *time_arr = (uint32_t *)(data+layout.time_arr);
+    int64_t *serv_time = (int64_t *)(data+layout.serv_time);
+    int32_t *mem_req = (int32_t *)(data+layout.mem_req);
+    uint32_t *name_id = (uint32_t *)(data+layout.name_id);
+    uint64_t *name_offset = (uint64_t *)(data+layout.name_offset);
+    char *strings = data+layout.strings;
+    arrival_t arrival;
+    uint64_t string_bytes = 0;
+    name_offset[0] = 0;
+    for (long i = 0; i < n_jobs; i++){
+        next_arrival(gen, &arrival);
+        time_arr[i] = arrival.time_arr;
+        serv_time[i] = arrival.serv_time;
+        mem_req[i] = arrival.mem_req;
+        name_id[i] = (uint32_t)i;
+        string_bytes += job_name(i, arrival.name);
+        memcpy(strings+name_offset[i], arrival.name, string_bytes-name_offset[i]);
+        name_offset[i+1] = string_bytes;
+    }
+
+    header.string_bytes = string_bytes;
+    memcpy(data, &header, sizeof(header));
+    munmap(data, layout.bytes);
+    if (ftruncate(fd, layout.strings+string_bytes) == -1){
+        perror("ftruncate");
+        exit(EXIT_FAILURE);
+    }
+}
+
+int main(int argc, char *argv[]){
+    long n_jobs = -1;
+    int mem_size = DEFAULT_MEM_SIZE;
+    int binary = 0;
+    generator_t gen = {DEFAULT_SEED, DEFAULT_RATE, 0, 0, 0};
+    int opt;
+
+    while ((opt = getopt(argc, argv, ":n:s:r:d:M:b")) != -1){
+        if (opt == 'n'){
+            n_jobs = strtol(optarg, NULL, 10);
+        }
+        else if (opt == 's'){
+            gen.state = strtoull(optarg, NULL, 10);
+        }
+        else if (opt == 'r'){
+            gen.rate = atof(optarg);
+        }
+        else if (opt == 'd' && strcmp(optarg, BIMODAL) == 0){
+            gen.bimodal = 1;
+        }
+        else if (opt == 'd' && strcmp(optarg, UNIFORM) == 0){
+            gen.bimodal = 0;
+        }
+        else if (opt == 'M'){
+            mem_size = atoi(optarg);
+        }
+        else if (opt == 'b'){
+            binary = 1;
+        }
+        else {
+            break;
+        }
+    }
+    if (n_jobs < 0 || n_jobs > UINT32_MAX || gen.rate <= 0 || mem_size <= 0 
+        || optind != argc-1){
+        fprintf(stderr, "Usage: %s -n <processes> [-s seed] [-r rate] [-d uniform|bimodal] [-M memory] [-b] <output>\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    gen.max_req = mem_size/4 > 0 ? mem_size/4 : 1;
+
+    if (binary){
+        int fd = open(argv[optind], O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd == -1){
+            perror(argv[optind]);
+            exit(EXIT_FAILURE);
+        }
+        write_binary(fd, &gen, n_jobs);
+        close(fd);
+    }
+    else {
+        FILE *out = fopen(argv[optind], "w");
+        if (out == NULL){
+            perror(argv[optind]);
+            exit(EXIT_FAILURE);
+        }
+        write_text(out, &gen, n_jobs);
+        fclose(out);
+    }
+    return 0;
+}
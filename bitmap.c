@@ -0,0 +1,261 @@
+/**
+ * Implementation of `bitmap_t`, which packs one bit per allocation unit. Runs of free units are found a word at a time
+ * with count-trailing-zeros, and ranges are set or cleared with masked word writes.
+*/
+#include "bitmap.h"
+
+static void update_summary(bitmap_t *bitmap, int word);
+
+/**
+ * Allocates memory for a new bitmap of `size` allocation units, and returns a pointer to it. All allocation units are
+ * initially free.
+*/
+bitmap_t *new_bitmap(int size){
+    bitmap_t *bitmap = (bitmap_t *)malloc(sizeof(bitmap_t));
+    assert(bitmap);
+    bitmap->size = size;
+    bitmap->rover = 0;
+    bitmap->n_words = (size+WORD_BITS-1)/WORD_BITS;
+    bitmap->n_summary = (bitmap->n_words+WORD_BITS-1)/WORD_BITS;
+    bitmap->words = (uint64_t *)new_region(sizeof(uint64_t)*bitmap->n_words);
+    bitmap->full_words = (uint64_t *)new_region(sizeof(uint64_t)*bitmap->n_summary);
+    bitmap->empty_words = (uint64_t *)new_region(sizeof(uint64_t)*bitmap->n_summary);
+
+    // Every word starts out empty. Summary bits past the last word count as both full and empty, so that skipping
+    // over them in either direction runs off the end of the bitmap.
+    for (int i = 0; i < bitmap->n_summary; i++){
+        bitmap->empty_words[i] = ~0ULL;
+    }
+    if (bitmap->n_words%WORD_BITS != 0){
+        bitmap->full_words[bitmap->n_summary-1] = ~0ULL << (bitmap->n_words%WORD_BITS);
+    }
+
+    // Units past the end of memory are permanently allocated
+    if (size%WORD_BITS != 0){
+        bitmap->words[bitmap->n_words-1] = ~0ULL << (size%WORD_BITS);
+        update_summary(bitmap, bitmap->n_words-1);
+    }
+    return bitmap;
+}
+
+/**
+ * Returns the index of the first word at or after `word` whose bit in `summary` is clear, or `bitmap->n_words` if 
+ * there is none.
+*/
+static int next_word(bitmap_t *bitmap, uint64_t *summary, int word){
+    int i = word/WORD_BITS;
+    if (i >= bitmap->n_summary){
+        return bitmap->n_words;
+    }
+    uint64_t bits = ~summary[i] & (~0ULL << (word%WORD_BITS));
+    while (bits == 0){
+        if (++i == bitmap->n_summary){
+            return bitmap->n_words;
+        }
+        bits = ~summary[i];
+    }
+    return i*WORD_BITS + __builtin_ctzll(bits);
+}
+
+/**
+ * Returns the address of the first free unit at or after `address`, or `bitmap->size` if there is none. Words that
+ * are entirely allocated are skipped using `full_words`.
+*/
+static int next_free(bitmap_t *bitmap, int address){
+    int i = address/WORD_BITS;
+    if (i >= bitmap->n_words){
+        return bitmap->size;
+    }
+    uint64_t free_bits = ~bitmap->words[i] & (~0ULL << (address%WORD_BITS));
+    if (free_bits == 0){
+        i = next_word(bitmap, bitmap->full_words, i+1);
+        if (i == bitmap->n_words){
+            return bitmap->size;
+        }
+        free_bits = ~bitmap->words[i];
+    }
+    return i*WORD_BITS + __builtin_ctzll(free_bits);
+}
+
+/**
+ * Returns the address of the first allocated unit at or after `address`, or `bitmap->size` if there is none. Words
+ * that are entirely free are skipped using `empty_words`.
+*/
+static int next_full(bitmap_t *bitmap, int address){
+    int i = address/WORD_BITS;
+    if (i >= bitmap->n_words){
+        return bitmap->size;
+    }
+    uint64_t full_bits = bitmap->words[i] & (~0ULL << (address%WORD_BITS));
+    if (full_bits == 0){
+        i = next_word(bitmap, bitmap->empty_words, i+1);
+        if (i == bitmap->n_words){
+            return bitmap->size;
+        }
+        full_bits = bitmap->words[i];
+    }
+    int full = i*WORD_BITS + __builtin_ctzll(full_bits);
+    return full < bitmap->size ? full : bitmap->size;
+}
+
+/**
+ * Returns the address of the first run of free units that starts at or after `address`, or `bitmap->size` if there 
+ * is none. A run that `address` falls in the middle of is skipped.
+*/
+static int next_run(bitmap_t *bitmap, int address){
+    int start = next_free(bitmap, address);
+    int prev = address-1;
+    if (start == address && address > 0 && !((bitmap->words[prev/WORD_BITS] >> (prev%WORD_BITS)) & 1)){
+        start = next_free(bitmap, next_full(bitmap, start));
+    }
+    return start;
+}
+
+/**
+ * Allocates `mem_req` units from a run of free units chosen according to `policy`, walking each run in address order:
+ *  - `FIT_BEST` keeps the smallest run that is large enough, stopping early at a run of exactly `mem_req` units,
+ *  - `FIT_WORST` keeps the largest run,
+ *  - `FIT_FIRST` takes the first run that is large enough,
+ *  - `FIT_NEXT` takes the first run that is large enough at or after `rover`, wrapping around to address 0.
+ * Ties between runs of the same size go to the lowest address. Returns the starting address of the allocation, or
+ * `NO_RUN` if no run is large enough.
+*/
+int bitmap_fit(bitmap_t *bitmap, int mem_req, int policy){
+    int fit_size = policy == FIT_WORST ? mem_req-1 : bitmap->size+1;
+    int fit_address = NO_RUN;
+    int from = policy == FIT_NEXT ? bitmap->rover : 0;
+
+    int start = next_run(bitmap, from);
+    while (1){
+        // Next Fit wraps around once to address 0
+        if (start >= bitmap->size){
+            if (policy != FIT_NEXT || from == 0){
+                break;
+            }
+            from = 0;
+            start = next_run(bitmap, 0);
+            continue;
+        }
+        int end = next_full(bitmap, start);
+        int run = end-start;
+        if (policy == FIT_WORST ? run > fit_size : run >= mem_req && run < fit_size){
+            fit_size = run;
+            fit_address = start;
+            if (policy != FIT_WORST && (policy != FIT_BEST || run == mem_req)){
+                break;
+            }
+        }
+        start = next_free(bitmap, end);
+    }
+
+    if (fit_address != NO_RUN){
+        bitmap_set_range(bitmap, fit_address, mem_req);
+        bitmap->rover = fit_address+mem_req;
+    }
+    return fit_address;
+}
+
+/**
+ * Counts the `free_units` in the bitmap, the number of runs of free units `n_runs`, and the size of the `largest` run.
+*/
+void bitmap_stats(bitmap_t *bitmap, long *free_units, long *n_runs, int *largest){
+    *free_units = 0;
+    *n_runs = 0;
+    *largest = 0;
+
+    int start = next_free(bitmap, 0);
+    while (start < bitmap->size){
+        int end = next_full(bitmap, start);
+        *free_units += end-start;
+        (*n_runs)++;
+        if (end-start > *largest){
+            *largest = end-start;
+        }
+        start = next_free(bitmap, end);
+    }
+}
+
+/**
+ * Returns a mask of the bits from `from` up to but not including `to` within a single word, where 0 <= from < to <= 64.
+*/
+static uint64_t range_mask(int from, int to){
+    uint64_t high = to == WORD_BITS ? ~0ULL : (1ULL << to)-1;
+    return high & (~0ULL << from);
+}
+
+/**
+ * Updates the summary bits of `word` after it has been written.
+*/
+static void update_summary(bitmap_t *bitmap, int word){
+    uint64_t bit = 1ULL << (word%WORD_BITS);
+    if (bitmap->words[word] == ~0ULL){
+        bitmap->full_words[word/WORD_BITS] |= bit;
+    }
+    else {
+        bitmap->full_words[word/WORD_BITS] &= ~bit;
+    }
+    if (bitmap->words[word] == 0){
+        bitmap->empty_words[word/WORD_BITS] |= bit;
+    }
+    else {
+        bitmap->empty_words[word/WORD_BITS] &= ~bit;
+    }
+}
+
+/**
+ * Writes `fill` over the whole words from `first` up to but not including `last`, and updates their summary bits.
+*/
+static void fill_words(bitmap_t *bitmap, int first, int last, uint64_t fill){
+    for (int i = first; i < last; i++){
+        bitmap->words[i] = fill;
+        update_summary(bitmap, i);
+    }
+}
+
+/**
+ * Marks `size` units starting at `address` as allocated, writing whole words where the range covers them.
+*/
+void bitmap_set_range(bitmap_t *bitmap, int address, int size){
+    if (size <= 0){
+        return;
+    }
+    int first = address/WORD_BITS, last = (address+size-1)/WORD_BITS;
+    if (first == last){
+        bitmap->words[first] |= range_mask(address%WORD_BITS, (address+size-1)%WORD_BITS+1);
+        update_summary(bitmap, first);
+        return;
+    }
+    bitmap->words[first] |= range_mask(address%WORD_BITS, WORD_BITS);
+    update_summary(bitmap, first);
+    fill_words(bitmap, first+1, last, ~0ULL);
+    bitmap->words[last] |= range_mask(0, (address+size-1)%WORD_BITS+1);
+    update_summary(bitmap, last);
+}
+
+/**
+ * Marks `size` units starting at `address` as free, writing whole words where the range covers them.
+*/
+void bitmap_clear_range(bitmap_t *bitmap, int address, int size){
+    if (size <= 0){
+        return;
+    }
+    int first = address/WORD_BITS, last = (address+size-1)/WORD_BITS;
+    if (first == last){
+        bitmap->words[first] &= ~range_mask(address%WORD_BITS, (address+size-1)%WORD_BITS+1);
+        update_summary(bitmap, first);
+        return;
+    }
+    bitmap->words[first] &= ~range_mask(address%WORD_BITS, WORD_BITS);
+    update_summary(bitmap, first);
+    fill_words(bitmap, first+1, last, 0);
+    bitmap->words[last] &= ~range_mask(0, (address+size-1)%WORD_BITS+1);
+    update_summary(bitmap, last);
+}
+
+// Frees all memory used by `bitmap`.
+void free_bitmap(bitmap_t *bitmap){
+    free_region(bitmap->words, sizeof(uint64_t)*bitmap->n_words);
+    free_region(bitmap->full_words, sizeof(uint64_t)*bitmap->n_summary);
+    free_region(bitmap->empty_words, sizeof(uint64_t)*bitmap->n_summary);
+    free(bitmap);
+}
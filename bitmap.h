@@ -0,0 +1,58 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include "region.h"
+
+#ifndef __BITMAP_H__
+#define __BITMAP_H__
+
+// The number of allocation units packed into each word of the bitmap
+#define WORD_BITS 64
+// Returned when no run of free allocation units is large enough
+#define NO_RUN -1
+
+// Policies for choosing between runs of free allocation units that are large enough
+#define FIT_BEST 0
+#define FIT_WORST 1
+#define FIT_FIRST 2
+#define FIT_NEXT 3
+
+/**
+ * Packs one bit per allocation unit into 64-bit `words`, where a set bit is an allocated unit and a clear bit is a
+ * free unit. `size` is the number of allocation units, and `n_words` the number of words. Bits past `size` in the
+ * last word are kept set, so that scans for allocated units always stop inside the bitmap.
+ * `full_words` and `empty_words` summarise `words` with one bit per word, set when the word is entirely allocated or
+ * entirely free, so that scans over large regions skip 64 words at a time. `n_summary` is the number of summary words.
+ * `rover` is where the next Next Fit search starts.
+*/
+typedef struct bitmap{
+    int size;
+    int rover;
+    int n_words;
+    int n_summary;
+    uint64_t *words;
+    uint64_t *full_words;
+    uint64_t *empty_words;
+} bitmap_t;
+
+// Allocates memory for a new bitmap of `size` allocation units, all initially free, and returns a pointer to it
+bitmap_t *new_bitmap(int size);
+
+// Allocates `mem_req` units from a run of free units that is large enough, chosen according to `policy`. Returns the
+// starting address of the allocation, or `NO_RUN` if no run is large enough.
+int bitmap_fit(bitmap_t *bitmap, int mem_req, int policy);
+
+// Counts the free units, the runs of free units, and the size of the largest run
+void bitmap_stats(bitmap_t *bitmap, long *free_units, long *n_runs, int *largest);
+
+// Marks `size` units starting at `address` as allocated
+void bitmap_set_range(bitmap_t *bitmap, int address, int size);
+
+// Marks `size` units starting at `address` as free
+void bitmap_clear_range(bitmap_t *bitmap, int address, int size);
+
+// Frees all memory used by `bitmap`
+void free_bitmap(bitmap_t *bitmap);
+
+#endif
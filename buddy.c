@@ -0,0 +1,149 @@
+/**
+ * Implementation of `buddy_t`, a power-of-two buddy allocator with one free list per block order.
+*/
+#include "buddy.h"
+
+static void push_block(buddy_t *buddy, int address, int order);
+static void remove_block(buddy_t *buddy, int address, int order);
+
+/**
+ * Allocates memory for a new buddy allocator over `size` allocation units, and returns a pointer to it. Memory starts
+ * out as one free block per set bit of `size`, with the largest block at address 0, so every block is aligned to its
+ * own size.
+*/
+buddy_t *new_buddy(int size){
+    buddy_t *buddy = (buddy_t *)malloc(sizeof(buddy_t));
+    assert(buddy);
+    buddy->size = size;
+    buddy->max_order = 63-__builtin_clzll((uint64_t)size);
+    buddy->nonempty = 0;
+    buddy->free_units = 0;
+    buddy->n_blocks = 0;
+    for (int i = 0; i < MAX_ORDERS; i++){
+        buddy->heads[i] = NO_BLOCK;
+    }
+    buddy->free_order = (int *)new_region(sizeof(int)*size);
+    buddy->next = (int *)new_region(sizeof(int)*size);
+    buddy->prev = (int *)new_region(sizeof(int)*size);
+
+    int address = 0;
+    for (int order = buddy->max_order; order >= 0; order--){
+        if (size & (1 << order)){
+            push_block(buddy, address, order);
+            address += 1 << order;
+        }
+    }
+    return buddy;
+}
+
+/**
+ * Returns the order of the smallest block that holds `mem_req` units.
+*/
+static int order_of(int mem_req){
+    if (mem_req <= 1){
+        return 0;
+    }
+    return 64-__builtin_clzll((uint64_t)(mem_req-1));
+}
+
+/**
+ * Allocates the smallest power-of-two block of at least `mem_req` units. The smallest non-empty free list that is
+ * large enough is found from `nonempty`, and its block is halved until it is the right order, freeing the upper half
+ * each time. Returns the starting address of the block, or `NO_BLOCK` if no block is large enough.
+*/
+int buddy_allocate(buddy_t *buddy, int mem_req){
+    int order = order_of(mem_req);
+    if (order > buddy->max_order){
+        return NO_BLOCK;
+    }
+    uint64_t large_enough = buddy->nonempty & (~0ULL << order);
+    if (large_enough == 0){
+        return NO_BLOCK;
+    }
+
+    int block_order = __builtin_ctzll(large_enough);
+    int address = buddy->heads[block_order];
+    remove_block(buddy, address, block_order);
+    while (block_order > order){
+        block_order--;
+        push_block(buddy, address + (1 << block_order), block_order);
+    }
+    return address;
+}
+
+/**
+ * Frees the block starting at `address` that was allocated for `mem_req` units. While the block's buddy is a free
+ * block of the same order, the two are merged into a block of the next order.
+*/
+void buddy_free(buddy_t *buddy, int address, int mem_req){
+    int order = order_of(mem_req);
+    while (order < buddy->max_order){
+        int buddy_address = address ^ (1 << order);
+        if (buddy_address >= buddy->size || buddy->free_order[buddy_address] != order+1){
+            break;
+        }
+        remove_block(buddy, buddy_address, order);
+        if (buddy_address < address){
+            address = buddy_address;
+        }
+        order++;
+    }
+    push_block(buddy, address, order);
+}
+
+/**
+ * Returns the size of the largest free block, or 0 if memory is full.
+*/
+int buddy_largest(buddy_t *buddy){
+    if (buddy->nonempty == 0){
+        return 0;
+    }
+    return 1 << (63-__builtin_clzll(buddy->nonempty));
+}
+
+// Frees all memory used by `buddy`.
+void free_buddy(buddy_t *buddy){
+    free_region(buddy->free_order, sizeof(int)*buddy->size);
+    free_region(buddy->next, sizeof(int)*buddy->size);
+    free_region(buddy->prev, sizeof(int)*buddy->size);
+    free(buddy);
+}
+
+/**
+ * Pushes the free block of `order` starting at `address` onto the head of its free list.
+*/
+static void push_block(buddy_t *buddy, int address, int order){
+    int head = buddy->heads[order];
+    buddy->next[address] = head;
+    buddy->prev[address] = NO_BLOCK;
+    if (head != NO_BLOCK){
+        buddy->prev[head] = address;
+    }
+    buddy->heads[order] = address;
+    buddy->free_order[address] = order+1;
+    buddy->nonempty |= 1ULL << order;
+    buddy->free_units += 1 << order;
+    buddy->n_blocks++;
+}
+
+/**
+ * Unlinks the free block of `order` starting at `address` from its free list.
+*/
+static void remove_block(buddy_t *buddy, int address, int order){
+    int next = buddy->next[address], prev = buddy->prev[address];
+    if (prev != NO_BLOCK){
+        buddy->next[prev] = next;
+    }
+    else {
+        buddy->heads[order] = next;
+    }
+    if (next != NO_BLOCK){
+        buddy->prev[next] = prev;
+    }
+    if (buddy->heads[order] == NO_BLOCK){
+        buddy->nonempty &= ~(1ULL << order);
+    }
+    buddy->free_order[address] = 0;
+    buddy->free_units -= 1 << order;
+    buddy->n_blocks--;
+}
@@ -0,0 +1,52 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include "region.h"
+
+#ifndef __BUDDY_H__
+#define __BUDDY_H__
+
+// Marks an empty link in a free list, and is returned when no block is large enough
+#define NO_BLOCK -1
+// The number of block orders supported, enough for any memory size that fits in an int
+#define MAX_ORDERS 32
+
+/**
+ * A power-of-two buddy allocator over `size` allocation units. Memory is split into blocks of 2^order units, each
+ * aligned to its size, and blocks of each order that are free are kept on a doubly linked free list, headed by
+ * `heads[order]` and linked through `next` and `prev`. `free_order` holds the order plus one of the free block
+ * starting at each address, and zero elsewhere. `nonempty` has bit `order` set when that free list is non-empty.
+ * When `size` is not a power of two, memory starts out as one block per set bit of `size`, largest first, and blocks
+ * are never merged beyond those. `free_units` and `n_blocks` count the free units and free blocks.
+*/
+typedef struct buddy{
+    int size;
+    int max_order;
+    uint64_t nonempty;
+    long free_units;
+    long n_blocks;
+    int heads[MAX_ORDERS];
+    int *free_order;
+    int *next;
+    int *prev;
+} buddy_t;
+
+// Allocates memory for a new buddy allocator over `size` allocation units, all initially free, and returns a pointer
+// to it
+buddy_t *new_buddy(int size);
+
+// Allocates the smallest power-of-two block of at least `mem_req` units, splitting a larger block if needed. Returns
+// the starting address of the block, or `NO_BLOCK` if no block is large enough.
+int buddy_allocate(buddy_t *buddy, int mem_req);
+
+// Frees the block starting at `address` that was allocated for `mem_req` units, merging it with its free buddies
+void buddy_free(buddy_t *buddy, int address, int mem_req);
+
+// Returns the size of the largest free block, or 0 if memory is full
+int buddy_largest(buddy_t *buddy);
+
+// Frees all memory used by `buddy`
+void free_buddy(buddy_t *buddy);
+
+#endif
@@ -0,0 +1,78 @@
+/**
+ * Implementation of the manager's side of `channel_t`, a control channel to "process" in shared memory.
+*/
+#define _GNU_SOURCE
+#include <unistd.h>
+#include <string.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "channel.h"
+
+/**
+ * Sleeps until `word` is no longer `value`, or a wake-up. May return early, so callers check `word` again.
+*/
+static void futex_wait(_Atomic uint32_t *word, uint32_t value){
+    syscall(SYS_futex, word, FUTEX_WAIT, value, NULL, NULL, 0);
+}
+
+/**
+ * Wakes the other side of a channel if it is sleeping on `word`.
+*/
+static void futex_wake(_Atomic uint32_t *word){
+    syscall(SYS_futex, word, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+/**
+ * Creates a channel in a new memfd sized to hold it, and maps it shared, returning a pointer to the mapping with both
+ * counters at zero. The memfd is close-on-exec, and is returned in `fd` to be passed on to "process" with dup2(),
+ * which clears the flag.
+*/
+channel_t *new_channel(int *fd){
+    *fd = memfd_create("channel", MFD_CLOEXEC);
+    if (*fd == -1 || ftruncate(*fd, sizeof(channel_t)) == -1){
+        perror("memfd_create");
+        exit(EXIT_FAILURE);
+    }
+    channel_t *channel = (channel_t *)mmap(NULL, sizeof(channel_t), PROT_READ | PROT_WRITE, MAP_SHARED, *fd, 0);
+    if (channel == MAP_FAILED){
+        perror("mmap");
+        exit(EXIT_FAILURE);
+    }
+    return channel;
+}
+
+/**
+ * Writes the message `op` with `time` into the next slot of `channel`, publishes it by counting it in `sent` with a 
+ * release store, and wakes "process". Waits for "process" to catch up first if every slot is in use.
+*/
+void channel_send(channel_t *channel, int op, const uint8_t time[CHANNEL_TIME_BYTES]){
+    uint32_t sent = atomic_load_explicit(&channel->sent, memory_order_relaxed);
+    uint32_t received;
+    while (sent - (received = atomic_load_explicit(&channel->received, memory_order_acquire)) == CHANNEL_SLOTS){
+        futex_wait(&channel->received, received);
+    }
+
+    uint32_t slot = sent%CHANNEL_SLOTS;
+    channel->op[slot] = (uint8_t)op;
+    memcpy(channel->time[slot], time, CHANNEL_TIME_BYTES);
+    atomic_store_explicit(&channel->sent, sent+1, memory_order_release);
+    futex_wake(&channel->sent);
+}
+
+/**
+ * Waits until "process" has counted every message sent on `channel` in `received`, sleeping on `received` while it
+ * has not. The acquire load makes `echo` and `sha` visible once it has.
+*/
+void channel_wait(channel_t *channel){
+    uint32_t sent = atomic_load_explicit(&channel->sent, memory_order_relaxed);
+    uint32_t received;
+    while ((received = atomic_load_explicit(&channel->received, memory_order_acquire)) != sent){
+        futex_wait(&channel->received, received);
+    }
+}
+
+// Unmaps `channel`.
+void free_channel(channel_t *channel){
+    munmap(channel, sizeof(channel_t));
+}
@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#ifndef __CHANNEL_H__
+#define __CHANNEL_H__
+
+// The option that makes "process" take its messages through a channel mapped from its STDIN
+#define CHANNEL_OPTION "--shm"
+// The number of messages a channel can hold at once
+#define CHANNEL_SLOTS 8
+// The number of bytes of the time sent with each message
+#define CHANNEL_TIME_BYTES 4
+// The length of the sha string written back on termination, including its terminating null byte
+#define CHANNEL_SHA_LEN 65
+// The size of a cache line, which the counters written by either side are kept apart by
+#define CHANNEL_LINE 64
+
+// Messages, numbered as the operations that "process" hashes
+#define CHANNEL_START 0
+#define CHANNEL_STOP 1
+#define CHANNEL_CONTINUE 2
+#define CHANNEL_TERM 3
+
+/**
+ * A control channel between the manager and one "process", in a memfd mapped by both. The manager writes each 
+ * message, an operation in `op` and a big-endian time in `time`, into the slot `sent` wraps to, and then counts it in
+ * `sent`. "process" handles messages in order, writing the least significant byte of the time of START and CONTINUE
+ * into `echo`, and the sha string into `sha` on TERM, and counts each handled message in `received`. Each side sleeps
+ * on the other side's counter with a futex, and wakes the other side after counting. The counters count up forever,
+ * and are on their own cache lines.
+*/
+typedef struct channel{
+    _Alignas(CHANNEL_LINE) _Atomic uint32_t sent;
+    _Alignas(CHANNEL_LINE) _Atomic uint32_t received;
+    _Alignas(CHANNEL_LINE) uint8_t op[CHANNEL_SLOTS];
+    uint8_t time[CHANNEL_SLOTS][CHANNEL_TIME_BYTES];
+    uint8_t echo;
+    char sha[CHANNEL_SHA_LEN];
+} channel_t;
+
+// Creates a channel in a new memfd and maps it, returning a pointer to the mapping. The memfd is returned in `fd`, to
+// be passed on to "process" as its STDIN and then closed.
+channel_t *new_channel(int *fd);
+
+// Sends the message `op` with the big-endian `time` on `channel`, waiting for room if every slot is in use
+void channel_send(channel_t *channel, int op, const uint8_t time[CHANNEL_TIME_BYTES]);
+
+// Waits until "process" has handled every message sent on `channel`
+void channel_wait(channel_t *channel);
+
+// Unmaps `channel`
+void free_channel(channel_t *channel);
+
+#endif
@@ -1,16 +1,20 @@
 /**
  * Implementation of the circular array data structure. Elements are enqueued to the tail, and dequeued from the head.
+ * The capacity is always a power of two, so that indexes wrap around with a mask rather than a division.
 */
 
 #include "circular_array.h"
 
+// Wraps `index` around the end of `circ_array->processes`
+#define WRAP(circ_array, index) ((index)&((circ_array)->capacity-1))
+
 /**
  * Allocates memory for a new circular array `circ_array`, initialises its attributes, and returns a pointer to it.
 */
 circ_array_t *new_circular_array(){
     circ_array_t *circ_array = (circ_array_t*)malloc(sizeof(circ_array_t));
     assert(circ_array);
-    circ_array->processes = (process_t**)malloc(sizeof(process_t*) * INIT_SIZE);
+    circ_array->processes = (proc_id_t*)malloc(sizeof(proc_id_t) * INIT_SIZE);
     assert(circ_array->processes);
     circ_array->head = INIT_IDX;
     circ_array->tail = INIT_IDX;
@@ -21,111 +25,146 @@ circ_array_t *new_circular_array(){
 }
 
 /**
- * Enqueues process_t* `process` at the tail of `circ_array->processes`. Also dynamically reallocates memory for 
+ * Enqueues process `id` at the tail of `circ_array->processes`. Also dynamically reallocates memory for 
  * `circ_array->processes` if its size has reached maximum capacity. 
 */
-void enqueue(circ_array_t *circ_array, process_t *process){
-    // Queue is full, reallocate memory
-    if (circ_array->size == circ_array->capacity){
-        int prev_size = circ_array->capacity;
-        circ_array->capacity *= REALLOC_SCALE;
-        circ_array->processes = (process_t**)realloc(circ_array->processes, sizeof(process_t*)*circ_array->capacity);
-        assert(circ_array->processes);
-
-        // If the head was in front of the tail, shift all the processes from before the head to after it
-        if (circ_array->head >= circ_array->tail){
-            for (int i = 0; i < circ_array->tail; i++){
-                circ_array->processes[prev_size+i] = circ_array->processes[i];
-            }
-            circ_array->tail = circ_array->tail + prev_size;
-        }   
-    }
+void enqueue(circ_array_t *circ_array, proc_id_t id){
+    reserve_array(circ_array, 1);
 
-    // Enqueue `process`
-    circ_array->processes[circ_array->tail] = process;
-    circ_array->tail = (circ_array->tail+1)%circ_array->capacity;
+    // Enqueue process `id`
+    circ_array->processes[circ_array->tail] = id;
+    circ_array->tail = WRAP(circ_array, circ_array->tail+1);
     circ_array->size++;
 }
 
 /**
- * Dequeues a `process` from the head of `circ_array->processes`, returning a pointer to it.
+ * Makes room for at least `n` more processes in `circ_array->processes`. If it is too small, its capacity is scaled by
+ * `REALLOC_SCALE` as many times as needed and it is reallocated once. Processes that had wrapped around to the start
+ * are then moved with one memcpy() to follow on from the end of the old capacity, so the queue stays contiguous from
+ * the head.
 */
-process_t *dequeue(circ_array_t *circ_array){
-    if (circ_array->size == 0){
-        return 0;
+void reserve_array(circ_array_t *circ_array, int n){
+    if (circ_array->size+n <= circ_array->capacity){
+        return;
     }
-    else {
-        process_t *process = circ_array->processes[circ_array->head];
-        circ_array->size--;
-        circ_array->head = (circ_array->head + 1)%circ_array->capacity;
-        return process;
+    int prev_size = circ_array->capacity;
+    while (circ_array->capacity < circ_array->size+n){
+        circ_array->capacity *= REALLOC_SCALE;
     }
-}
+    circ_array->processes = (proc_id_t*)realloc(circ_array->processes, sizeof(proc_id_t)*circ_array->capacity);
+    assert(circ_array->processes);
 
-// Returns a pointer to a process at an `index` of `circ_array->processes`, starting from the head.
-process_t *get_process(circ_array_t *circ_array, int index){
-    return circ_array->processes[(circ_array->head+index)%circ_array->capacity];
+    // If the queue wrapped around, move the processes from before the head to after the old end
+    int wrapped = circ_array->head+circ_array->size-prev_size;
+    if (wrapped > 0){
+        memcpy(circ_array->processes+prev_size, circ_array->processes, sizeof(proc_id_t)*wrapped);
+    }
+    circ_array->tail = circ_array->head+circ_array->size;
 }
 
 /**
- * Removes a process at an `index` of `circ_array->processes` by swapping elements until it reaches the head
- * and dequeueing. Returns a pointer to the process.
+ * Enqueues the `n` processes `ids` at the tail of `circ_array->processes` in order. Room is reserved for all of them
+ * first, and they are copied with at most two memcpy() calls, one on either side of the end of the array.
 */
-process_t *remove_process(circ_array_t *circ_array, int index){
-    if (circ_array->size == 0){
-        return 0;
+void append_array(circ_array_t *circ_array, const proc_id_t *ids, int n){
+    reserve_array(circ_array, n);
+
+    int before_end = circ_array->capacity-circ_array->tail;
+    if (before_end > n){
+        before_end = n;
     }
-    else {
-        // Swap elements until the element which was at `index` reaches the head, then dequeue it
-        for (int i = index; i > 0; i--){
-            process_t *tmp = circ_array->processes[(circ_array->head+i)%circ_array->capacity];
-            circ_array->processes[(circ_array->head+i)%circ_array->capacity] = circ_array->processes[(circ_array->head+i-1)%circ_array->capacity];
-            circ_array->processes[(circ_array->head+i-1)%circ_array->capacity] = tmp;
-        }
-        return dequeue(circ_array);
+    memcpy(circ_array->processes+circ_array->tail, ids, sizeof(proc_id_t)*before_end);
+    memcpy(circ_array->processes, ids+before_end, sizeof(proc_id_t)*(n-before_end));
+    circ_array->tail = WRAP(circ_array, circ_array->tail+n);
+    circ_array->size += n;
+}
+
+/**
+ * Moves every process of `src` to the tail of `dest` in order, leaving `src` empty. `dest` grows at most once, and 
+ * each of the (at most two) contiguous segments of `src` is appended with append_array().
+*/
+void splice_array(circ_array_t *dest, circ_array_t *src){
+    reserve_array(dest, src->size);
+
+    int before_end = src->capacity-src->head;
+    if (before_end > src->size){
+        before_end = src->size;
     }
+    append_array(dest, src->processes+src->head, before_end);
+    append_array(dest, src->processes, src->size-before_end);
+    truncate_array(src, 0);
 }
 
 /**
- * Used with qsort() in the Shortest Job First scheduling algorithm to sort processes in ascending order, by 
- * service time, arrival time, and name. 
+ * Dequeues a process from the head of `circ_array->processes`, returning its id, or `NO_PROC` if it is empty.
 */
-int qsort_comparator(const void *process_1, const void *process_2){
-    process_t *p1 = (process_t*)process_1;
-    process_t *p2 = (process_t*)process_2;
-    return p1->serv_time - p2->serv_time;
-    if (p1->serv_time == p2->serv_time){
-        if (p1->time_arr == p2->time_arr){
-            return strcmp(p1->name, p2->name);
-        }
-        else {
-            return p1->time_arr - p2->time_arr;
-        }
+proc_id_t dequeue(circ_array_t *circ_array){
+    if (circ_array->size == 0){
+        return NO_PROC;
     }
     else {
-        return p1->serv_time - p2->serv_time;
+        proc_id_t id = circ_array->processes[circ_array->head];
+        circ_array->size--;
+        circ_array->head = WRAP(circ_array, circ_array->head+1);
+        return id;
     }
 }
 
+// Returns the id of the process at an `index` of `circ_array->processes`, starting from the head.
+proc_id_t get_process(circ_array_t *circ_array, int index){
+    return circ_array->processes[WRAP(circ_array, circ_array->head+index)];
+}
+
+// Replaces the process at an `index` of `circ_array->processes`, starting from the head, with process `id`.
+void set_process(circ_array_t *circ_array, int index, proc_id_t id){
+    circ_array->processes[WRAP(circ_array, circ_array->head+index)] = id;
+}
+
 /**
- * Prints out all elements contained in a `circ_array`, starting from the head.
+ * Removes a process at an `index` of `circ_array->processes` by shifting the processes between it and the nearer end
+ * of the queue over by one, keeping the order of the others. Returns the id of the process.
 */
-void print_array(circ_array_t *circ_array){
+proc_id_t remove_process(circ_array_t *circ_array, int index){
     if (circ_array->size == 0){
-        return;
+        return NO_PROC;
     }
-    else if (circ_array->head < circ_array->tail){
-        for (int i = circ_array->head; i < circ_array->tail; i++){
-            printf("index %d: %u %s %ld %d\n", i, circ_array->processes[i]->time_arr, circ_array->processes[i]->name, circ_array->processes[i]->serv_time, circ_array->processes[i]->mem_req);
+    proc_id_t id = get_process(circ_array, index);
+
+    // Shift the processes before `index` towards the tail, and dequeue the head
+    if (index < circ_array->size/2){
+        for (int i = index; i > 0; i--){
+            set_process(circ_array, i, get_process(circ_array, i-1));
         }
+        dequeue(circ_array);
     }
+    // Shift the processes after `index` towards the head, and drop the tail
     else {
-        for (int i = circ_array->head; i < circ_array->capacity; i++){
-            printf("index %d: %u %s %ld %d\n", i, circ_array->processes[i]->time_arr, circ_array->processes[i]->name, circ_array->processes[i]->serv_time, circ_array->processes[i]->mem_req);
-        }
-        for (int i = 0; i < circ_array->tail; i++){
-            printf("index %d: %u %s %ld %d\n", i, circ_array->processes[i]->time_arr, circ_array->processes[i]->name, circ_array->processes[i]->serv_time, circ_array->processes[i]->mem_req);
+        for (int i = index; i < circ_array->size-1; i++){
+            set_process(circ_array, i, get_process(circ_array, i+1));
         }
+        truncate_array(circ_array, circ_array->size-1);
+    }
+    return id;
+}
+
+/**
+ * Keeps only the first `size` processes of `circ_array->processes`, starting from the head, by moving the tail back. 
+ * A pass that copies each process it keeps down to the next kept index with set_process(), then truncates to the 
+ * number kept, removes any number of processes in O(n) while keeping the order of the rest.
+*/
+void truncate_array(circ_array_t *circ_array, int size){
+    circ_array->size = size;
+    circ_array->tail = WRAP(circ_array, circ_array->head+size);
+}
+
+/**
+ * Prints out all processes of `table` contained in a `circ_array`, starting from the head.
+*/
+void print_array(circ_array_t *circ_array, proc_table_t *table){
+    for (int i = 0; i < circ_array->size; i++){
+        proc_id_t id = get_process(circ_array, i);
+        printf("index %d: %u %s %ld %d\n", WRAP(circ_array, circ_array->head+i), table->time_arr[id], 
+               table->processes[id].name, table->serv_time[id], table->mem_req[id]);
     }
 }
 
@@ -133,4 +172,4 @@ void print_array(circ_array_t *circ_array){
 void free_array(circ_array_t *circ_array){
     free(circ_array->processes);
     free(circ_array);
-}
\ No newline at end of file
+}
@@ -2,72 +2,65 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+#include "proc_table.h"
 
 #ifndef __CIRCULAR_ARRAY_H__
 #define __CIRCULAR_ARRAY_H__
 
-// The initial size of each `processes` array
-#define INIT_SIZE 5
+// The initial size of each `processes` array, which is kept a power of two so that indexes wrap with a mask
+#define INIT_SIZE 8
 // The scale by which the `processes` array is dynamically reallocated 
 #define REALLOC_SCALE 2
-// The maximum length of process names
-#define MAX_NAME_LEN 9
 // The initial indexes of `head` and `tail`
 #define INIT_IDX 0 
-// Read and write sides for the file descriptor array
-#define READ_WRITE 2
 
 /**
- * Each process has an arrival time, a unique name, a service time, and a memory requirement. `serv_time_remaining` is
- * used to keep track of the remaining service time of a process after each cycle of the process manager, and 
- * `mem_addr` is used to keep track of the memory address that the allocation for a process starts at. 
- * `pid` is the process id of the real process, and `fd_1`/`fd_2` are the arrays of file descriptors used for allowing
- * two-way communication between parent and child processes with pipe()
-*/ 
-typedef struct process{
-    unsigned int time_arr;
-    char name[MAX_NAME_LEN];
-    long serv_time;
-    int mem_req;
-    long serv_time_remaining;
-    int mem_addr;
-    int pid;
-    int fd_1[READ_WRITE], fd_2[READ_WRITE];
-} process_t;
-
-/**
- * Processes are enqueued to the tail of the `processes` array, and dequeued from the head. `capacity` is the maximum
- * capacity of the `processes` array, and `size` is the current number of processes contained in the queue.
+ * Processes are enqueued to the tail of the `processes` array, and dequeued from the head, by their ids in the process
+ * table. `capacity` is the maximum capacity of the `processes` array, always a power of two, and `size` is the current
+ * number of processes contained in the queue.
 */
 typedef struct circular_array{
     int head;
     int tail;
     int capacity;
     int size;
-    process_t **processes;
+    proc_id_t *processes;
 } circ_array_t;
 
 // Allocates memory for a new circular array `circ_array`, initialises its attributes, and returns a pointer to it.
 circ_array_t *new_circular_array();
 
-// Enqueues process_t* `process` at the tail of `circ_array->processes`, dynamically reallocating memory if 
+// Enqueues process `id` at the tail of `circ_array->processes`, dynamically reallocating memory if 
 // `circ_array->processes` has reached maximum capacity.
-void enqueue(circ_array_t *circ_array, process_t *process);
+void enqueue(circ_array_t *circ_array, proc_id_t id);
+
+// Makes room for at least `n` more processes in `circ_array->processes`, growing it at most once.
+void reserve_array(circ_array_t *circ_array, int n);
+
+// Enqueues the `n` processes `ids` at the tail of `circ_array->processes` in order, growing it at most once.
+void append_array(circ_array_t *circ_array, const proc_id_t *ids, int n);
+
+// Moves every process of `src` to the tail of `dest` in order, leaving `src` empty.
+void splice_array(circ_array_t *dest, circ_array_t *src);
+
+// Dequeues a process from the head of `circ_array->processes`, returning its id, or `NO_PROC` if it is empty.
+proc_id_t dequeue(circ_array_t *circ_array);
 
-// Dequeues a `process` from the head of `circ_array->processes`, returning a pointer to it.
-process_t *dequeue(circ_array_t *circ_array);
+// Returns the id of the process at an `index` of `circ_array->processes`, starting from the head.
+proc_id_t get_process(circ_array_t *circ_array, int index);
 
-// Returns a pointer to a process at an `index` of `circ_array->processes`, starting from the head.
-process_t *get_process(circ_array_t *circ_array, int index);
+// Replaces the process at an `index` of `circ_array->processes`, starting from the head, with process `id`.
+void set_process(circ_array_t *circ_array, int index, proc_id_t id);
 
-// Removes a `process` at an `index` of `circ_array->processes`. Returns a pointer to the `process`.
-process_t *remove_process(circ_array_t *circ_array, int index);
+// Removes the process at an `index` of `circ_array->processes`, keeping the order of the others. Returns its id.
+proc_id_t remove_process(circ_array_t *circ_array, int index);
 
-// Used with qsort() in the SJF scheduling algorithm to sort processes by service time, arrival time, and name. 
-int qsort_comparator(const void *process_1, const void *process_2);
+// Keeps only the first `size` processes of `circ_array->processes`, starting from the head. Together with 
+// set_process(), this removes any number of processes in one pass while keeping the order of the rest.
+void truncate_array(circ_array_t *circ_array, int size);
 
-// Prints out all elements contained in a `circ_array`, starting from the head.
-void print_array(circ_array_t *circ_array);
+// Prints out all processes of `table` contained in a `circ_array`, starting from the head.
+void print_array(circ_array_t *circ_array, proc_table_t *table);
 
 // Frees all memory used by `circ_array`.
 void free_array(circ_array_t *circ_array);
@@ -0,0 +1,233 @@
+/**
+ * Converts a text input file into a binary workload, which "allocate" maps and uses without parsing. Names are 
+ * interned, so a name used by several processes is only stored once. Usage: ./convert_workload <input> <output>, 
+ * where <input> may be "-" for standard input.
+*/
+#include "workload.h"
+
+// The number of processes and names the columns have room for at first, doubled whenever they fill up
+#define INIT_COLUMNS 1024
+// Marks an empty bucket of the name index, which no name can be, as names are never empty
+#define EMPTY_KEY 0
+
+/**
+ * The columns of a binary workload as they are built, each with room for `capacity` processes, and the interned name
+ * table: `n_names` names, each stored once in `strings` at `name_offset`, with `string_bytes` bytes used out of
+ * `string_capacity`. `index` maps the bytes of each name, as a key, to its id in `ids`, with open addressing over 
+ * `index_capacity` buckets.
+*/
+typedef struct columns{
+    uint64_t n_processes;
+    uint64_t capacity;
+    uint32_t *time_arr;
+    int64_t *serv_time;
+    int32_t *mem_req;
+    uint32_t *name_id;
+    uint64_t n_names;
+    uint64_t name_capacity;
+    uint64_t *name_offset;
+    char *strings;
+    uint64_t string_bytes;
+    uint64_t string_capacity;
+    uint64_t index_capacity;
+    uint64_t *keys;
+    uint32_t *ids;
+} columns_t;
+
+/**
+ * Returns `pointer` reallocated to `n` elements of `size` bytes, exiting if there is no memory.
+*/
+static void *grow(void *pointer, uint64_t n, size_t size){
+    pointer = realloc(pointer, n*size);
+    assert(pointer);
+    return pointer;
+}
+
+/**
+ * Returns the bucket of the name index of `columns` holding `key`, or the empty bucket it would go in. Names tend to 
+ * share their first bytes, so every bit of the key is mixed into the bucket.
+*/
+static uint64_t find_bucket(columns_t *columns, uint64_t key){
+    uint64_t hash = key;
+    hash = (hash ^ (hash >> 33)) * 0xFF51AFD7ED558CCDULL;
+    hash = (hash ^ (hash >> 33)) * 0xC4CEB9FE1A85EC53ULL;
+    uint64_t bucket = (hash ^ (hash >> 33)) & (columns->index_capacity-1);
+    while (columns->keys[bucket] != EMPTY_KEY && columns->keys[bucket] != key){
+        bucket = (bucket+1) & (columns->index_capacity-1);
+    }
+    return bucket;
+}
+
+/**
+ * Doubles the buckets of the name index of `columns`, putting every name back in.
+*/
+static void grow_index(columns_t *columns){
+    uint64_t *keys = columns->keys;
+    uint32_t *ids = columns->ids;
+    uint64_t old_capacity = columns->index_capacity;
+    columns->index_capacity *= 2;
+    columns->keys = (uint64_t *)calloc(columns->index_capacity, sizeof(uint64_t));
+    columns->ids = (uint32_t *)malloc(sizeof(uint32_t)*columns->index_capacity);
+    assert(columns->keys && columns->ids);
+    for (uint64_t b = 0; b < old_capacity; b++){
+        if (keys[b] != EMPTY_KEY){
+            uint64_t bucket = find_bucket(columns, keys[b]);
+            columns->keys[bucket] = keys[b];
+            columns->ids[bucket] = ids[b];
+        }
+    }
+    free(keys);
+    free(ids);
+}
+
+/**
+ * Returns the id of the name `name` in the name table of `columns`, adding it if it is not there yet. Names fit in 
+ * `MAX_NAME_LEN` with their terminator, so the first 8 bytes, zero-padded, are the key of a name in the index.
+*/
+static uint32_t intern(columns_t *columns, const char name[MAX_NAME_LEN]){
+    uint64_t key;
+    memcpy(&key, name, sizeof(key));
+    uint64_t bucket = find_bucket(columns, key);
+    if (columns->keys[bucket] != EMPTY_KEY){
+        return columns->ids[bucket];
+    }
+    if (columns->n_names == UINT32_MAX){
+        fprintf(stderr, "Error: too many names\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t len = strnlen(name, MAX_NAME_LEN);
+    if (columns->n_names+1 == columns->name_capacity){
+        columns->name_capacity *= 2;
+        columns->name_offset = grow(columns->name_offset, columns->name_capacity, sizeof(uint64_t));
+    }
+    while (columns->string_bytes+len > columns->string_capacity){
+        columns->string_capacity *= 2;
+        columns->strings = grow(columns->strings, columns->string_capacity, 1);
+    }
+    memcpy(columns->strings+columns->string_bytes, name, len);
+    columns->string_bytes += len;
+    uint32_t id = (uint32_t)columns->n_names++;
+    columns->name_offset[columns->n_names] = columns->string_bytes;
+
+    columns->keys[bucket] = key;
+    columns->ids[bucket] = id;
+    // Keep the index at most half full
+    if (2*columns->n_names > columns->index_capacity){
+        grow_index(columns);
+    }
+    return id;
+}
+
+/**
+ * Appends the process `id` of `table` to `columns`, doubling them first if they are full.
+*/
+static void append_process(columns_t *columns, proc_table_t *table, proc_id_t id){
+    if (columns->n_processes == columns->capacity){
+        columns->capacity *= 2;
+        columns->time_arr = grow(columns->time_arr, columns->capacity, sizeof(uint32_t));
+        columns->serv_time = grow(columns->serv_time, columns->capacity, sizeof(int64_t));
+        columns->mem_req = grow(columns->mem_req, columns->capacity, sizeof(int32_t));
+        columns->name_id = grow(columns->name_id, columns->capacity, sizeof(uint32_t));
+    }
+    uint64_t i = columns->n_processes++;
+    columns->time_arr[i] = table->time_arr[id];
+    columns->serv_time[i] = table->serv_time[id];
+    columns->mem_req[i] = table->mem_req[id];
+    columns->name_id[i] = intern(columns, table->processes[id].name);
+}
+
+/**
+ * Writes `n` `bytes` to `out` at `offset`, padding with zeros from `*pos`, the number of bytes written so far, which
+ * is then moved past them.
+*/
+static void write_at(FILE *out, size_t *pos, size_t offset, const void *bytes, size_t n){
+    for (; *pos < offset; (*pos)++){
+        fputc(0, out);
+    }
+    if (n > 0 && fwrite(bytes, 1, n, out) != n){
+        perror("fwrite");
+        exit(EXIT_FAILURE);
+    }
+    *pos += n;
+}
+
+/**
+ * Writes `columns` to `out` as a binary workload: the header, then each column where workload_layout() puts it.
+*/
+static void write_workload(FILE *out, columns_t *columns){
+    workload_header_t header;
+    workload_layout_t layout;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, WORKLOAD_MAGIC, sizeof(header.magic));
+    header.version = WORKLOAD_VERSION;
+    header.n_processes = columns->n_processes;
+    header.n_names = columns->n_names;
+    header.string_bytes = columns->string_bytes;
+    workload_layout(&header, &layout);
+
+    size_t pos = 0;
+    uint64_t n = columns->n_processes;
+    write_at(out, &pos, 0, &header, sizeof(header));
+    write_at(out, &pos, layout.time_arr, columns->time_arr, sizeof(uint32_t)*n);
+    write_at(out, &pos, layout.serv_time, columns->serv_time, sizeof(int64_t)*n);
+    write_at(out, &pos, layout.mem_req, columns->mem_req, sizeof(int32_t)*n);
+    write_at(out, &pos, layout.name_id, columns->name_id, sizeof(uint32_t)*n);
+    write_at(out, &pos, layout.name_offset, columns->name_offset, sizeof(uint64_t)*(columns->n_names+1));
+    write_at(out, &pos, layout.strings, columns->strings, columns->string_bytes);
+}
+
+int main(int argc, char *argv[]){
+    if (argc != 3){
+        fprintf(stderr, "Usage: %s <input> <output>\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    columns_t columns = {0};
+    columns.capacity = INIT_COLUMNS;
+    columns.time_arr = grow(NULL, INIT_COLUMNS, sizeof(uint32_t));
+    columns.serv_time = grow(NULL, INIT_COLUMNS, sizeof(int64_t));
+    columns.mem_req = grow(NULL, INIT_COLUMNS, sizeof(int32_t));
+    columns.name_id = grow(NULL, INIT_COLUMNS, sizeof(uint32_t));
+    columns.name_capacity = INIT_COLUMNS;
+    columns.name_offset = grow(NULL, INIT_COLUMNS, sizeof(uint64_t));
+    columns.name_offset[0] = 0;
+    columns.string_capacity = INIT_COLUMNS;
+    columns.strings = grow(NULL, INIT_COLUMNS, 1);
+    columns.index_capacity = INIT_COLUMNS;
+    columns.keys = (uint64_t *)calloc(INIT_COLUMNS, sizeof(uint64_t));
+    columns.ids = (uint32_t *)malloc(sizeof(uint32_t)*INIT_COLUMNS);
+    assert(columns.keys && columns.ids);
+
+    // Each process is read through a table of one, the same way the simulation reads them
+    workload_t *workload = load_workload(argv[1], 0);
+    proc_table_t *table = new_proc_table();
+    proc_id_t id = new_process(table);
+    while (peek_arrival(workload) != NO_ARRIVAL){
+        read_arrival(workload, table, id);
+        append_process(&columns, table, id);
+    }
+    free_workload(workload);
+    free_proc_table(table);
+
+    FILE *out = fopen(argv[2], "wb");
+    if (out == NULL){
+        perror(argv[2]);
+        exit(EXIT_FAILURE);
+    }
+    write_workload(out, &columns);
+    if (fclose(out) != 0){
+        perror(argv[2]);
+        exit(EXIT_FAILURE);
+    }
+
+    free(columns.time_arr);
+    free(columns.serv_time);
+    free(columns.mem_req);
+    free(columns.name_id);
+    free(columns.name_offset);
+    free(columns.strings);
+    free(columns.keys);
+    free(columns.ids);
+    return 0;
+}
@@ -0,0 +1,228 @@
+/**
+ * Implementation of `event_loop_t`, which waits on every real process at once with epoll, observing echoes through
+ * their pipes, exits through their pidfds, and stops through SIGCHLD.
+*/
+#include "event_loop.h"
+
+// Marks the event of the SIGCHLD signalfd, rather than of a process
+#define CHILD_EVENT UINT64_MAX
+// The epoll data of the pipe and the pidfd of process `id`
+#define PIPE_EVENT(id) ((uint64_t)(id)*2)
+#define PIDFD_EVENT(id) ((uint64_t)(id)*2+1)
+// Set in `waiting` once a process has been reaped, as the end of its pipe may be reported in the same batch
+#define EXITED 8
+
+/**
+ * Adds `fd` to the epoll set of `loop`, to be reported with `data` when it is readable.
+*/
+static void add_fd(event_loop_t *loop, int fd, uint64_t data){
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = data;
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1){
+        perror("epoll_ctl");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Clears `event` from the events awaited from `process`.
+*/
+static void done_waiting(event_loop_t *loop, process_t *process, int event){
+    process->waiting &= ~event;
+    loop->n_waiting--;
+}
+
+// Blocks SIGCHLD in the calling thread, and the threads it starts later, so that an event loop alone receives it.
+void block_child_signals(){
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    if (sigprocmask(SIG_BLOCK, &mask, NULL) == -1){
+        perror("sigprocmask");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Allocates memory for a new event loop `loop` over the real processes of `table`, and returns a pointer to it. 
+ * SIGCHLD must already be blocked with block_child_signals().
+*/
+event_loop_t *new_event_loop(proc_table_t *table){
+    event_loop_t *loop = (event_loop_t *)malloc(sizeof(event_loop_t));
+    assert(loop);
+    loop->stopping = (proc_id_t *)malloc(sizeof(proc_id_t)*INIT_STOPPING);
+    assert(loop->stopping);
+    loop->capacity = INIT_STOPPING;
+    loop->n_stopping = 0;
+    loop->n_waiting = 0;
+    loop->table = table;
+
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    loop->child_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (loop->epoll_fd == -1 || loop->child_fd == -1){
+        perror("event loop");
+        exit(EXIT_FAILURE);
+    }
+    add_fd(loop, loop->child_fd, CHILD_EVENT);
+    return loop;
+}
+
+/**
+ * Opens a pidfd for the real process `id`, and adds it and the read side of `fd_2` to the epoll set of `loop`.
+*/
+void watch_process(event_loop_t *loop, proc_id_t id){
+    process_t *process = &loop->table->processes[id];
+    process->pidfd = pidfd_open(process->pid, 0);
+    if (process->pidfd == -1){
+        perror("pidfd_open");
+        exit(EXIT_FAILURE);
+    }
+    process->waiting = 0;
+    add_fd(loop, process->fd_2[0], PIPE_EVENT(id));
+    add_fd(loop, process->pidfd, PIDFD_EVENT(id));
+}
+
+/**
+ * Removes the real process `id` from the epoll set of `loop`, and closes its pidfd. Either may have been removed 
+ * already, once the process exited.
+*/
+void unwatch_process(event_loop_t *loop, proc_id_t id){
+    process_t *process = &loop->table->processes[id];
+    epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, process->fd_2[0], NULL);
+    epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, process->pidfd, NULL);
+    close(process->pidfd);
+    process->pidfd = NO_PIDFD;
+}
+
+/**
+ * Records that `event` is awaited from the real process `id`. A process awaiting a stop is also added to `stopping`,
+ * dynamically reallocating it if it is full, as SIGCHLD does not say which process stopped.
+*/
+void await_event(event_loop_t *loop, proc_id_t id, int event){
+    loop->table->processes[id].waiting |= event;
+    loop->n_waiting++;
+    if (event == AWAIT_STOP){
+        if (loop->n_stopping == loop->capacity){
+            loop->capacity *= STOP_REALLOC_SCALE;
+            loop->stopping = (proc_id_t *)realloc(loop->stopping, sizeof(proc_id_t)*loop->capacity);
+            assert(loop->stopping);
+        }
+        loop->stopping[loop->n_stopping++] = id;
+    }
+}
+
+/**
+ * Checks each process in `stopping` for a stop without blocking, and removes those that have stopped. Signals that
+ * arrive together are merged into one SIGCHLD, so every one of them is checked each time.
+*/
+static void check_stopped(event_loop_t *loop){
+    for (int i = 0; i < loop->n_stopping; i++){
+        process_t *process = &loop->table->processes[loop->stopping[i]];
+        siginfo_t info;
+        info.si_pid = 0;
+        if (waitid(P_PIDFD, process->pidfd, &info, WSTOPPED | WNOHANG) == -1){
+            perror("waitid");
+            exit(EXIT_FAILURE);
+        }
+        if (info.si_pid != 0){
+            done_waiting(loop, process, AWAIT_STOP);
+            loop->stopping[i--] = loop->stopping[--loop->n_stopping];
+        }
+    }
+}
+
+/**
+ * Handles a readable pipe of the real process `id`. An awaited echo is read and checked. A pipe also becomes readable
+ * when its process exits, which is only expected while awaiting the exit or just after it, and the pipe is then 
+ * removed from the set.
+*/
+static void handle_pipe(event_loop_t *loop, proc_id_t id){
+    process_t *process = &loop->table->processes[id];
+    if (process->waiting & AWAIT_ECHO){
+        uint8_t read_byte;
+        read(process->fd_2[0], &read_byte, sizeof(read_byte));
+        if (read_byte != process->echo){
+            perror("incorrect byte");
+        }
+        done_waiting(loop, process, AWAIT_ECHO);
+    }
+    else if (process->waiting & (AWAIT_EXIT | EXITED)){
+        epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, process->fd_2[0], NULL);
+    }
+    else {
+        fprintf(stderr, "Error: unexpected output from process %s\n", process->name);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Handles a readable pidfd of the real process `id`, which has exited. It is reaped, and the pidfd is removed from 
+ * the set.
+*/
+static void handle_exit(event_loop_t *loop, proc_id_t id){
+    process_t *process = &loop->table->processes[id];
+    if (!(process->waiting & AWAIT_EXIT)){
+        fprintf(stderr, "Error: process %s exited unexpectedly\n", process->name);
+        exit(EXIT_FAILURE);
+    }
+    siginfo_t info;
+    if (waitid(P_PIDFD, process->pidfd, &info, WEXITED | WNOHANG) == -1){
+        perror("waitid");
+        exit(EXIT_FAILURE);
+    }
+    epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, process->pidfd, NULL);
+    done_waiting(loop, process, AWAIT_EXIT);
+    process->waiting |= EXITED;
+}
+
+/**
+ * Handles events until every awaited event has happened, in whatever order the processes get to them. Stops that
+ * happened before the loop started are picked up first, as their SIGCHLD may already have been consumed.
+*/
+void run_event_loop(event_loop_t *loop){
+    struct epoll_event events[MAX_EVENTS];
+
+    check_stopped(loop);
+    while (loop->n_waiting > 0){
+        int n_events = epoll_wait(loop->epoll_fd, events, MAX_EVENTS, -1);
+        if (n_events == -1){
+            perror("epoll_wait");
+            exit(EXIT_FAILURE);
+        }
+        for (int i = 0; i < n_events; i++){
+            uint64_t data = events[i].data.u64;
+            if (data == CHILD_EVENT){
+                struct signalfd_siginfo fdsi;
+                while (read(loop->child_fd, &fdsi, sizeof(fdsi)) == sizeof(fdsi));
+                check_stopped(loop);
+            }
+            else if (data%2 == 0){
+                handle_pipe(loop, (proc_id_t)(data/2));
+            }
+            else {
+                handle_exit(loop, (proc_id_t)(data/2));
+            }
+        }
+    }
+}
+
+// Sends `signal` to the real process `process`, through its pidfd if it has one. Returns 0 on success, and -1 
+// otherwise.
+int signal_process(process_t *process, int signal){
+    if (process->pidfd != NO_PIDFD){
+        return pidfd_send_signal(process->pidfd, signal, NULL, 0);
+    }
+    return kill(process->pid, signal);
+}
+
+// Frees all memory used by `loop`.
+void free_event_loop(event_loop_t *loop){
+    close(loop->epoll_fd);
+    close(loop->child_fd);
+    free(loop->stopping);
+    free(loop);
+}
@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/pidfd.h>
+#include <sys/signalfd.h>
+#include <sys/wait.h>
+#include "proc_table.h"
+
+#ifndef __EVENT_LOOP_H__
+#define __EVENT_LOOP_H__
+
+// Events that can be awaited from a real process, as bits of its `waiting`
+#define AWAIT_ECHO 1
+#define AWAIT_STOP 2
+#define AWAIT_EXIT 4
+
+// The most events taken from epoll at once
+#define MAX_EVENTS 64
+// The initial number of processes that can be awaiting a stop at once
+#define INIT_STOPPING 8
+// The scale by which the processes awaiting a stop are dynamically reallocated
+#define STOP_REALLOC_SCALE 2
+
+/**
+ * An event loop over the real processes of `table`. `epoll_fd` is an epoll set holding the read side of the `fd_2` 
+ * pipe and the pidfd of every watched process, and `child_fd`, a signalfd for SIGCHLD, which tells when a process
+ * may have stopped. `n_waiting` counts the events still awaited across all processes, and the `n_stopping` processes
+ * in `stopping`, with room for `capacity`, are those awaiting a stop.
+*/
+typedef struct event_loop{
+    int epoll_fd;
+    int child_fd;
+    int n_waiting;
+    int n_stopping;
+    int capacity;
+    proc_id_t *stopping;
+    proc_table_t *table;
+} event_loop_t;
+
+// Blocks SIGCHLD in the calling thread, and the threads it starts later, so that an event loop alone receives it.
+// Must be called before any other thread is started.
+void block_child_signals();
+
+// Allocates memory for a new event loop over the real processes of `table`, and returns a pointer to it
+event_loop_t *new_event_loop(proc_table_t *table);
+
+// Opens a pidfd for the real process `id`, and adds it and the pipe it writes to to `loop`
+void watch_process(event_loop_t *loop, proc_id_t id);
+
+// Removes the real process `id` from `loop`, and closes its pidfd
+void unwatch_process(event_loop_t *loop, proc_id_t id);
+
+// Records that `event`, one of `AWAIT_ECHO`, `AWAIT_STOP` and `AWAIT_EXIT`, is awaited from the real process `id`
+void await_event(event_loop_t *loop, proc_id_t id, int event);
+
+// Handles events until every awaited event has happened
+void run_event_loop(event_loop_t *loop);
+
+// Sends `signal` to the real process `process`, through its pidfd if it has one. Returns 0 on success, and -1 
+// otherwise.
+int signal_process(process_t *process, int signal);
+
+// Frees all memory used by `loop`
+void free_event_loop(event_loop_t *loop);
+
+#endif
@@ -0,0 +1,80 @@
+/**
+ * Implementation of the binary min-heap of processes used as the ready queue of the Shortest Job First algorithm.
+*/
+
+#include "heap.h"
+
+/**
+ * Allocates memory for a new heap `heap` of processes in `table`, initialises its attributes, and returns a pointer 
+ * to it.
+*/
+proc_heap_t *new_heap(proc_table_t *table){
+    proc_heap_t *heap = (proc_heap_t*)malloc(sizeof(proc_heap_t));
+    assert(heap);
+    heap->processes = (proc_id_t*)malloc(sizeof(proc_id_t) * INIT_SIZE);
+    assert(heap->processes);
+    heap->capacity = INIT_SIZE;
+    heap->size = 0;
+    heap->table = table;
+
+    return heap;
+}
+
+/**
+ * Inserts process `id` into `heap` by placing it at the end and sifting it up past any larger parents. Also
+ * dynamically reallocates memory for `heap->processes` if its size has reached maximum capacity.
+*/
+void heap_push(proc_heap_t *heap, proc_id_t id){
+    if (heap->size == heap->capacity){
+        heap->capacity *= REALLOC_SCALE;
+        heap->processes = (proc_id_t*)realloc(heap->processes, sizeof(proc_id_t)*heap->capacity);
+        assert(heap->processes);
+    }
+
+    int i = heap->size++;
+    while (i > 0){
+        int parent = (i-1)/2;
+        if (compare_processes(heap->table, heap->processes[parent], id) <= 0){
+            break;
+        }
+        heap->processes[i] = heap->processes[parent];
+        i = parent;
+    }
+    heap->processes[i] = id;
+}
+
+/**
+ * Removes the minimum process from `heap`, returning its id, or `NO_PROC` if `heap` is empty. The last process
+ * is moved to the root and sifted down past any smaller children.
+*/
+proc_id_t heap_pop(proc_heap_t *heap){
+    if (heap->size == 0){
+        return NO_PROC;
+    }
+
+    proc_id_t min = heap->processes[0];
+    proc_id_t last = heap->processes[--heap->size];
+    int i = 0;
+    while (1){
+        int child = 2*i+1;
+        if (child >= heap->size){
+            break;
+        }
+        if (child+1 < heap->size && compare_processes(heap->table, heap->processes[child+1], heap->processes[child]) < 0){
+            child++;
+        }
+        if (compare_processes(heap->table, last, heap->processes[child]) <= 0){
+            break;
+        }
+        heap->processes[i] = heap->processes[child];
+        i = child;
+    }
+    heap->processes[i] = last;
+    return min;
+}
+
+// Frees all memory used by `heap`.
+void free_heap(proc_heap_t *heap){
+    free(heap->processes);
+    free(heap);
+}
@@ -0,0 +1,35 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "circular_array.h"
+
+#ifndef __HEAP_H__
+#define __HEAP_H__
+
+/**
+ * A binary min-heap of the ids of processes in `table`, ordered by compare_processes(): service time, then arrival
+ * time, then name. `processes[0]` is the minimum, and the children of `processes[i]` are `processes[2i+1]` and 
+ * `processes[2i+2]`. `capacity` is the maximum capacity of the `processes` array, and `size` is the current number of
+ * processes.
+*/
+typedef struct proc_heap{
+    int capacity;
+    int size;
+    proc_id_t *processes;
+    proc_table_t *table;
+} proc_heap_t;
+
+// Allocates memory for a new heap `heap` of processes in `table`, initialises its attributes, and returns a pointer 
+// to it
+proc_heap_t *new_heap(proc_table_t *table);
+
+// Inserts process `id` into `heap`, dynamically reallocating memory if `heap` has reached maximum capacity
+void heap_push(proc_heap_t *heap, proc_id_t id);
+
+// Removes the minimum process from `heap`, returning its id, or `NO_PROC` if `heap` is empty
+proc_id_t heap_pop(proc_heap_t *heap);
+
+// Frees all memory used by `heap`
+void free_heap(proc_heap_t *heap);
+
+#endif
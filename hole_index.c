@@ -0,0 +1,316 @@
+/**
+ * Implementation of `hole_index_t`, an index of the free holes in memory ordered by size or by address.
+*/
+#include "hole_index.h"
+
+static void insert_hole(hole_index_t *index, int address, int size);
+static void remove_hole(hole_index_t *index, int address);
+static int take_hole(hole_index_t *index, int address, int mem_req);
+static int best_fit_hole(hole_index_t *index, int mem_req);
+static int first_fit_from(hole_index_t *index, int hole, int from, int mem_req);
+
+/**
+ * Allocates memory for a new hole index over `size` allocation units, with holes ordered by `order`, and returns a
+ * pointer to it. All allocation units are initially free, forming a single hole that starts at address 0.
+*/
+hole_index_t *new_hole_index(int size, int order){
+    hole_index_t *index = (hole_index_t *)malloc(sizeof(hole_index_t));
+    assert(index);
+    index->hole_size = (int *)new_region(sizeof(int)*size);
+    index->hole_end = (int *)new_region(sizeof(int)*size);
+    index->max_size = (int *)new_region(sizeof(int)*size);
+    index->left = (int *)new_region(sizeof(int)*size);
+    index->right = (int *)new_region(sizeof(int)*size);
+
+    index->size = size;
+    index->order = order;
+    index->root = NIL_HOLE;
+    index->rover = 0;
+    index->free_units = 0;
+    index->n_holes = 0;
+    insert_hole(index, 0, size);
+    return index;
+}
+
+/**
+ * Allocates `mem_req` units using the Best Fit algorithm: the smallest hole that is large enough is used, with ties
+ * going to the hole with the lowest address. Any remaining units of the hole are returned to the index. Returns the
+ * starting address of the allocation, or `NIL_HOLE` if no hole is large enough.
+*/
+int hole_index_best_fit(hole_index_t *index, int mem_req){
+    return take_hole(index, best_fit_hole(index, mem_req), mem_req);
+}
+
+/**
+ * Allocates `mem_req` units using the Worst Fit algorithm: the largest hole is used, with ties going to the hole with
+ * the lowest address. Returns the starting address of the allocation, or `NIL_HOLE` if no hole is large enough.
+*/
+int hole_index_worst_fit(hole_index_t *index, int mem_req){
+    int largest = hole_index_largest(index);
+    if (largest < mem_req){
+        return NIL_HOLE;
+    }
+    // The lowest addressed hole of the largest size is the Best Fit for that size
+    return take_hole(index, best_fit_hole(index, largest), mem_req);
+}
+
+/**
+ * Allocates `mem_req` units using the First Fit algorithm: the lowest addressed hole that is large enough is used.
+ * Returns the starting address of the allocation, or `NIL_HOLE` if no hole is large enough.
+*/
+int hole_index_first_fit(hole_index_t *index, int mem_req){
+    return take_hole(index, first_fit_from(index, index->root, 0, mem_req), mem_req);
+}
+
+/**
+ * Allocates `mem_req` units using the Next Fit algorithm: the first hole that is large enough at or after `rover`
+ * is used, wrapping around to the lowest address if there is none. `rover` is then moved to the end of the
+ * allocation. Returns the starting address of the allocation, or `NIL_HOLE` if no hole is large enough.
+*/
+int hole_index_next_fit(hole_index_t *index, int mem_req){
+    int address = first_fit_from(index, index->root, index->rover, mem_req);
+    if (address == NIL_HOLE){
+        address = first_fit_from(index, index->root, 0, mem_req);
+    }
+    if (address != NIL_HOLE){
+        index->rover = address+mem_req;
+    }
+    return take_hole(index, address, mem_req);
+}
+
+/**
+ * Returns `size` units starting at `address` to the index. The freed units are merged with the holes directly before
+ * and after them, if any.
+*/
+void hole_index_free(hole_index_t *index, int address, int size){
+    // Merge with the hole ending directly before `address`
+    if (address > 0 && index->hole_end[address-1] != 0){
+        int prev = index->hole_end[address-1]-1;
+        size += index->hole_size[prev];
+        remove_hole(index, prev);
+        address = prev;
+    }
+    // Merge with the hole starting directly after the freed units
+    if (address+size < index->size && index->hole_size[address+size] > 0){
+        int next = address+size;
+        size += index->hole_size[next];
+        remove_hole(index, next);
+    }
+
+    insert_hole(index, address, size);
+}
+
+/**
+ * Returns the size of the largest hole, or 0 if memory is full. In size order this is the last hole, and in address
+ * order it is kept at the root.
+*/
+int hole_index_largest(hole_index_t *index){
+    int hole = index->root;
+    if (hole == NIL_HOLE){
+        return 0;
+    }
+    if (index->order == HOLE_BY_ADDRESS){
+        return index->max_size[hole];
+    }
+    while (index->right[hole] != NIL_HOLE){
+        hole = index->right[hole];
+    }
+    return index->hole_size[hole];
+}
+
+// Frees all memory used by `index`.
+void free_hole_index(hole_index_t *index){
+    free_region(index->hole_size, sizeof(int)*index->size);
+    free_region(index->hole_end, sizeof(int)*index->size);
+    free_region(index->max_size, sizeof(int)*index->size);
+    free_region(index->left, sizeof(int)*index->size);
+    free_region(index->right, sizeof(int)*index->size);
+    free(index);
+}
+
+/**
+ * Returns the smallest hole with at least `mem_req` units, with ties going to the lowest address, or `NIL_HOLE` if 
+ * there is none. Requires `HOLE_BY_SIZE`.
+*/
+static int best_fit_hole(hole_index_t *index, int mem_req){
+    int best_fit_address = NIL_HOLE;
+
+    // Holes are ordered by (size, address), so the first hole in order with a sufficient size is the Best Fit
+    int hole = index->root;
+    while (hole != NIL_HOLE){
+        if (index->hole_size[hole] >= mem_req){
+            best_fit_address = hole;
+            hole = index->left[hole];
+        }
+        else {
+            hole = index->right[hole];
+        }
+    }
+    return best_fit_address;
+}
+
+/**
+ * Returns the lowest addressed hole at or after `from` with at least `mem_req` units in the subtree rooted at `hole`,
+ * or `NIL_HOLE` if there is none. Requires `HOLE_BY_ADDRESS`. Subtrees whose `max_size` is too small are skipped.
+*/
+static int first_fit_from(hole_index_t *index, int hole, int from, int mem_req){
+    if (hole == NIL_HOLE || index->max_size[hole] < mem_req){
+        return NIL_HOLE;
+    }
+    if (hole < from){
+        return first_fit_from(index, index->right[hole], from, mem_req);
+    }
+    int found = first_fit_from(index, index->left[hole], from, mem_req);
+    if (found != NIL_HOLE){
+        return found;
+    }
+    if (index->hole_size[hole] >= mem_req){
+        return hole;
+    }
+    return first_fit_from(index, index->right[hole], from, mem_req);
+}
+
+/**
+ * Allocates `mem_req` units from the start of the hole at `address`, returning any remaining units of the hole to the
+ * index. Returns `address`, which may be `NIL_HOLE` if no hole was found.
+*/
+static int take_hole(hole_index_t *index, int address, int mem_req){
+    if (address != NIL_HOLE){
+        int hole_size = index->hole_size[address];
+        remove_hole(index, address);
+        if (hole_size > mem_req){
+            insert_hole(index, address+mem_req, hole_size-mem_req);
+        }
+    }
+    return address;
+}
+
+/**
+ * Returns the treap priority of the hole starting at `address`. Priorities are a multiplicative hash of the address,
+ * which keeps the index balanced in expectation while keeping the simulation deterministic.
+*/
+static unsigned int priority(int address){
+    return (unsigned int)address * 2654435761u;
+}
+
+/**
+ * Returns 1 if hole `a` comes before hole `b` in the order of the index, and 0 otherwise.
+*/
+static int hole_before(hole_index_t *index, int a, int b){
+    if (index->order == HOLE_BY_SIZE && index->hole_size[a] != index->hole_size[b]){
+        return index->hole_size[a] < index->hole_size[b];
+    }
+    return a < b;
+}
+
+/**
+ * Recomputes `max_size` of `hole` from its own size and its children.
+*/
+static void update(hole_index_t *index, int hole){
+    int max_size = index->hole_size[hole];
+    int left = index->left[hole], right = index->right[hole];
+    if (left != NIL_HOLE && index->max_size[left] > max_size){
+        max_size = index->max_size[left];
+    }
+    if (right != NIL_HOLE && index->max_size[right] > max_size){
+        max_size = index->max_size[right];
+    }
+    index->max_size[hole] = max_size;
+}
+
+/**
+ * Inserts hole `hole` into the subtree rooted at `root`, rotating it up while its priority is higher than its
+ * parent's. Returns the new root of the subtree.
+*/
+static int treap_insert(hole_index_t *index, int root, int hole){
+    if (root == NIL_HOLE){
+        update(index, hole);
+        return hole;
+    }
+    if (hole_before(index, hole, root)){
+        index->left[root] = treap_insert(index, index->left[root], hole);
+        int child = index->left[root];
+        if (priority(child) > priority(root)){
+            index->left[root] = index->right[child];
+            index->right[child] = root;
+            update(index, root);
+            update(index, child);
+            return child;
+        }
+    }
+    else {
+        index->right[root] = treap_insert(index, index->right[root], hole);
+        int child = index->right[root];
+        if (priority(child) > priority(root)){
+            index->right[root] = index->left[child];
+            index->left[child] = root;
+            update(index, root);
+            update(index, child);
+            return child;
+        }
+    }
+    update(index, root);
+    return root;
+}
+
+/**
+ * Merges two subtrees `a` and `b`, where every hole in `a` comes before every hole in `b`. Returns the new root.
+*/
+static int treap_merge(hole_index_t *index, int a, int b){
+    if (a == NIL_HOLE){
+        return b;
+    }
+    if (b == NIL_HOLE){
+        return a;
+    }
+    if (priority(a) > priority(b)){
+        index->right[a] = treap_merge(index, index->right[a], b);
+        update(index, a);
+        return a;
+    }
+    index->left[b] = treap_merge(index, a, index->left[b]);
+    update(index, b);
+    return b;
+}
+
+/**
+ * Removes hole `hole` from the subtree rooted at `root`, replacing it with the merge of its children. Returns the
+ * new root of the subtree.
+*/
+static int treap_remove(hole_index_t *index, int root, int hole){
+    if (root == hole){
+        return treap_merge(index, index->left[root], index->right[root]);
+    }
+    if (hole_before(index, hole, root)){
+        index->left[root] = treap_remove(index, index->left[root], hole);
+    }
+    else {
+        index->right[root] = treap_remove(index, index->right[root], hole);
+    }
+    update(index, root);
+    return root;
+}
+
+/**
+ * Records a hole of `size` units starting at `address` in the boundary tags, and adds it to the index.
+*/
+static void insert_hole(hole_index_t *index, int address, int size){
+    index->hole_size[address] = size;
+    index->hole_end[address+size-1] = address+1;
+    index->left[address] = NIL_HOLE;
+    index->right[address] = NIL_HOLE;
+    index->root = treap_insert(index, index->root, address);
+    index->free_units += size;
+    index->n_holes++;
+}
+
+/**
+ * Removes the hole starting at `address` from the index, and clears its boundary tags.
+*/
+static void remove_hole(hole_index_t *index, int address){
+    index->root = treap_remove(index, index->root, address);
+    index->free_units -= index->hole_size[address];
+    index->n_holes--;
+    index->hole_end[address+index->hole_size[address]-1] = 0;
+    index->hole_size[address] = 0;
+}
@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "region.h"
+
+#ifndef __HOLE_INDEX_H__
+#define __HOLE_INDEX_H__
+
+// Marks an empty link in the index, and is returned when no hole is large enough
+#define NIL_HOLE -1
+
+// Orders in which the holes can be indexed
+#define HOLE_BY_SIZE 0
+#define HOLE_BY_ADDRESS 1
+
+/**
+ * Free memory is kept as a set of holes (maximal runs of free allocation units), each identified by its starting
+ * address. The holes are indexed by a treap, ordered either by (size, address) or by address according to `order`.
+ * Each treap node also keeps `max_size`, the size of the largest hole in its subtree, so that the first hole in
+ * address order that is large enough can be found without visiting smaller ones.
+ * `hole_size` and `hole_end` are boundary tags at either end of each hole, used to find and merge neighbouring holes
+ * on deallocation: `hole_size` is non-zero at the start of a hole, and `hole_end` holds the start of a hole plus one
+ * at its last unit. Both are zero elsewhere, so the arrays can start out as untouched zero pages. `left` and `right`
+ * are the treap links of the hole starting at each address. `size` is the total number of allocation units,
+ * `free_units` and `n_holes` count the free units and holes, and `rover` is where the next Next Fit search starts.
+*/
+typedef struct hole_index{
+    int size;
+    int order;
+    int root;
+    int rover;
+    long free_units;
+    long n_holes;
+    int *hole_size;
+    int *hole_end;
+    int *max_size;
+    int *left;
+    int *right;
+} hole_index_t;
+
+// Allocates memory for a new hole index over `size` allocation units, all initially free, with holes ordered by
+// `order`, and returns a pointer to it
+hole_index_t *new_hole_index(int size, int order);
+
+// Allocates `mem_req` units from the smallest hole that is large enough, with ties going to the lowest address.
+// Requires `HOLE_BY_SIZE`. Returns the starting address of the allocation, or `NIL_HOLE` if no hole is large enough.
+int hole_index_best_fit(hole_index_t *index, int mem_req);
+
+// Allocates `mem_req` units from the largest hole, with ties going to the lowest address. Requires `HOLE_BY_SIZE`.
+// Returns the starting address of the allocation, or `NIL_HOLE` if no hole is large enough.
+int hole_index_worst_fit(hole_index_t *index, int mem_req);
+
+// Allocates `mem_req` units from the lowest addressed hole that is large enough. Requires `HOLE_BY_ADDRESS`.
+// Returns the starting address of the allocation, or `NIL_HOLE` if no hole is large enough.
+int hole_index_first_fit(hole_index_t *index, int mem_req);
+
+// Allocates `mem_req` units from the first hole that is large enough, searching upwards from the end of the previous
+// allocation and wrapping around. Requires `HOLE_BY_ADDRESS`. Returns the starting address of the allocation, or
+// `NIL_HOLE` if no hole is large enough.
+int hole_index_next_fit(hole_index_t *index, int mem_req);
+
+// Returns `size` units starting at `address` to the index, merging them with any neighbouring holes
+void hole_index_free(hole_index_t *index, int address, int size);
+
+// Returns the size of the largest hole, or 0 if memory is full
+int hole_index_largest(hole_index_t *index);
+
+// Frees all memory used by `index`
+void free_hole_index(hole_index_t *index);
+
+#endif
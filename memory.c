@@ -1,74 +1,193 @@
 /**
- * Implementation of `memory_t`, a struct containing a dynamic array used to simulate memory allocation.
+ * Implementation of `memory_t`, which simulates memory allocation using one of several strategies. Each strategy is a
+ * table of functions over its own free-space structure, and is looked up by name once at startup.
 */
 #include "memory.h"
+#include "profile.h"
+
+/* Best Fit and Worst Fit on the hole index, with holes ordered by size */
+static void *new_size_index(int size){
+    return new_hole_index(size, HOLE_BY_SIZE);
+}
+
+static int index_best_fit(void *state, int mem_req){
+    return hole_index_best_fit((hole_index_t *)state, mem_req);
+}
+
+static int index_worst_fit(void *state, int mem_req){
+    return hole_index_worst_fit((hole_index_t *)state, mem_req);
+}
+
+/* First Fit and Next Fit on the hole index, with holes ordered by address */
+static void *new_address_index(int size){
+    return new_hole_index(size, HOLE_BY_ADDRESS);
+}
+
+static int index_first_fit(void *state, int mem_req){
+    return hole_index_first_fit((hole_index_t *)state, mem_req);
+}
+
+static int index_next_fit(void *state, int mem_req){
+    return hole_index_next_fit((hole_index_t *)state, mem_req);
+}
+
+static void index_free(void *state, int address, int mem_req){
+    hole_index_free((hole_index_t *)state, address, mem_req);
+}
+
+static void index_stats(void *state, mem_stats_t *stats){
+    hole_index_t *index = (hole_index_t *)state;
+    stats->size = index->size;
+    stats->free_units = index->free_units;
+    stats->n_holes = index->n_holes;
+    stats->largest = hole_index_largest(index);
+}
+
+static void free_index(void *state){
+    free_hole_index((hole_index_t *)state);
+}
+
+/* Every fit on the bitmap, scanning the runs of free units */
+static void *new_bitmap_state(int size){
+    return new_bitmap(size);
+}
+
+static int bitmap_best_fit(void *state, int mem_req){
+    return bitmap_fit((bitmap_t *)state, mem_req, FIT_BEST);
+}
+
+static int bitmap_worst_fit(void *state, int mem_req){
+    return bitmap_fit((bitmap_t *)state, mem_req, FIT_WORST);
+}
+
+static int bitmap_first_fit(void *state, int mem_req){
+    return bitmap_fit((bitmap_t *)state, mem_req, FIT_FIRST);
+}
+
+static int bitmap_next_fit(void *state, int mem_req){
+    return bitmap_fit((bitmap_t *)state, mem_req, FIT_NEXT);
+}
+
+static void bitmap_free(void *state, int address, int mem_req){
+    bitmap_clear_range((bitmap_t *)state, address, mem_req);
+}
+
+static void bitmap_state_stats(void *state, mem_stats_t *stats){
+    bitmap_t *bitmap = (bitmap_t *)state;
+    int largest;
+    stats->size = bitmap->size;
+    bitmap_stats(bitmap, &stats->free_units, &stats->n_holes, &largest);
+    stats->largest = largest;
+}
+
+static void free_bitmap_state(void *state){
+    free_bitmap((bitmap_t *)state);
+}
+
+/* The buddy allocator, which keeps its own free lists on either backend */
+static void *new_buddy_state(int size){
+    return new_buddy(size);
+}
+
+static int buddy_state_allocate(void *state, int mem_req){
+    return buddy_allocate((buddy_t *)state, mem_req);
+}
+
+static void buddy_state_free(void *state, int address, int mem_req){
+    buddy_free((buddy_t *)state, address, mem_req);
+}
+
+static void buddy_stats(void *state, mem_stats_t *stats){
+    buddy_t *buddy = (buddy_t *)state;
+    stats->size = buddy->size;
+    stats->free_units = buddy->free_units;
+    stats->n_holes = buddy->n_blocks;
+    stats->largest = buddy_largest(buddy);
+}
+
+static void free_buddy_state(void *state){
+    free_buddy((buddy_t *)state);
+}
+
+// Memory allocation strategies on the `MEM_INDEX` backend
+static const mem_strategy_t index_strategies[] = {
+    {BEST_FIT, new_size_index, index_best_fit, index_free, index_stats, free_index},
+    {WORST_FIT, new_size_index, index_worst_fit, index_free, index_stats, free_index},
+    {FIRST_FIT, new_address_index, index_first_fit, index_free, index_stats, free_index},
+    {NEXT_FIT, new_address_index, index_next_fit, index_free, index_stats, free_index},
+    {BUDDY, new_buddy_state, buddy_state_allocate, buddy_state_free, buddy_stats, free_buddy_state},
+    {NULL}
+};
+
+// Memory allocation strategies on the `MEM_BITMAP` backend
+static const mem_strategy_t bitmap_strategies[] = {
+    {BEST_FIT, new_bitmap_state, bitmap_best_fit, bitmap_free, bitmap_state_stats, free_bitmap_state},
+    {WORST_FIT, new_bitmap_state, bitmap_worst_fit, bitmap_free, bitmap_state_stats, free_bitmap_state},
+    {FIRST_FIT, new_bitmap_state, bitmap_first_fit, bitmap_free, bitmap_state_stats, free_bitmap_state},
+    {NEXT_FIT, new_bitmap_state, bitmap_next_fit, bitmap_free, bitmap_state_stats, free_bitmap_state},
+    {BUDDY, new_buddy_state, buddy_state_allocate, buddy_state_free, buddy_stats, free_buddy_state},
+    {NULL}
+};
+
+/**
+ * Returns the memory allocation strategy called `name` implemented on `backend`, or NULL if there is none.
+*/
+const mem_strategy_t *find_mem_strategy(const char *name, int backend){
+    const mem_strategy_t *strategies = backend == MEM_BITMAP ? bitmap_strategies : index_strategies;
+    for (int i = 0; strategies[i].name != NULL; i++){
+        if (strcmp(strategies[i].name, name) == 0){
+            return &strategies[i];
+        }
+    }
+    return NULL;
+}
 
 /**
- * Allocates memory for a new dynamic array `memory`, and returns a pointer to it.
+ * Allocates memory for a new memory_t `memory` of `size` allocation units managed by `strategy`, and returns a pointer
+ * to it. All allocation units are initially free.
 */
-memory_t *new_mem_array(){
+memory_t *new_mem_array(const mem_strategy_t *strategy, int size){
     memory_t *memory = (memory_t *)malloc(sizeof(memory_t));
-    // All allocation units are initially `FREE`
-    memset(memory->mem_array, FREE, MEM_SIZE);
     assert(memory);
+    memory->strategy = strategy;
+    memory->state = strategy->new_state(size);
+    memory->size = size;
     return memory;
 }
 
 /**
- * Implementation of the Best Fit memory allocation algorithm, for simulating memory allocation for processes in the 
- * `input` queue before moving them to the `ready` queue. Takes memory_t* `memory`, and process_t* `process`, attempts 
- * to allocate memory according to `process->mem_req` requirements. Returns `best_fit_address`, which will be a 
- * non-negative integer indicating the starting address of the allocated memory if allocation was successful.
+ * Simulates memory allocation for a process in the `input` queue before it is moved to the `ready` queue. Takes
+ * memory_t* `memory`, and attempts to allocate `mem_req` units of memory using the strategy of `memory`. Returns a 
+ * non-negative integer indicating the starting address of the allocated memory if allocation was successful, and 
+ * `INIT_ADDR` otherwise.
 */
-int allocate_best_fit(memory_t *memory, process_t *process){
-    int address = 0;
-    int mem_req = process->mem_req;
-    int contiguous_units = 0;
-    int best_fit_size = MEM_SIZE;
-    int best_fit_address = INIT_ADDR;
-
-    for (int i = 0; i < MEM_SIZE; i++){
-        // A `FREE` allocation unit has been found. Increment `contiguous_units`. If this is the first `FREE` unit 
-        // in a chunk of memory, take note of the `address` where it starts. If the entire `mem_array` is `FREE`,
-        // return `address`.
-        if (memory->mem_array[i] == FREE){
-            if (contiguous_units == 0){
-                address = i;
-            }
-            else if (contiguous_units == MEM_SIZE-1){
-                best_fit_address = address;
-            }
-            contiguous_units++;
-        }
-        // A `FULL` allocation unit has been found or this is the end of `mem_array`, check if the number of 
-        // `contiguous_units` was sufficient for memory allocation, then reset the number of `contiguous_units`
-        if ((memory->mem_array[i] == FULL || i == MEM_SIZE-1) && contiguous_units > 0){
-            if (contiguous_units < best_fit_size && contiguous_units >= mem_req){
-                best_fit_size = contiguous_units;
-                best_fit_address = address;
-            }
-            contiguous_units = 0;
-
-        }
-    }
-
-    // If memory was succesfully allocated to memory, update the addresses in `mem_array` to `FULL`.
-    if (best_fit_address != INIT_ADDR){
-        process->mem_addr = best_fit_address;
-        for (int i = best_fit_address; i < best_fit_address+mem_req; i++){
-            memory->mem_array[i] = FULL;
-        }
+int mem_allocate(memory_t *memory, int mem_req){
+    PROFILE_BEGIN(start);
+    int address = memory->strategy->allocate(memory->state, mem_req);
+    PROFILE_END(PROBE_MEM_ALLOCATE, start);
+    if (address < 0){
+        return INIT_ADDR;
     }
-
-    return best_fit_address;
+    return address;
 }
 
 /**
- * Simulates memory deallocation by updating the memory addresses previously allocated to a `process` to `FREE`
+ * Simulates memory deallocation by returning the `mem_req` units starting at `address`, previously allocated to a 
+ * process, to `memory`.
  */
-void deallocate(memory_t *memory, process_t *process){
-    for (int i = process->mem_addr; i < process->mem_addr+process->mem_req; i++){
-        memory->mem_array[i] = FREE;
-    }
-    process->mem_addr = INIT_ADDR;
-}
\ No newline at end of file
+void deallocate(memory_t *memory, int address, int mem_req){
+    PROFILE_BEGIN(start);
+    memory->strategy->free(memory->state, address, mem_req);
+    PROFILE_END(PROBE_DEALLOCATE, start);
+}
+
+// Fills in `stats` with a snapshot of the free memory in `memory`.
+void mem_stats(memory_t *memory, mem_stats_t *stats){
+    memory->strategy->stats(memory->state, stats);
+}
+
+// Frees all memory used by `memory`.
+void free_mem_array(memory_t *memory){
+    memory->strategy->free_state(memory->state);
+    free(memory);
+}
@@ -2,33 +2,85 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
-#include "circular_array.h"
+#include "hole_index.h"
+#include "bitmap.h"
+#include "buddy.h"
 
 #ifndef __MEMORY_H__
 #define __MEMORY_H__
 
-// The static size of the memory being simulated
+// The default size of the memory being simulated, in allocation units
 #define MEM_SIZE 2048
-// Represents an allocation unit that is currently not allocated to a process
-#define FREE '0'
-// Represents an allocation unit that is currently allocated to a process
-#define FULL '1'
+// The largest memory size that can be simulated with `-M`, keeping addresses within an int
+#define MAX_MEM_SIZE 1000000000
 // Used to keep track of processes that are not allocated to memory yet
 #define INIT_ADDR -1
 
-// Uses a dynamic array `mem_array` to represent memory allocation units
+// Memory backends, selecting how free allocation units are represented
+#define MEM_INDEX 0
+#define MEM_BITMAP 1
+
+// Memory allocation strategies
+#define BEST_FIT "best-fit"
+#define FIRST_FIT "first-fit"
+#define NEXT_FIT "next-fit"
+#define WORST_FIT "worst-fit"
+#define BUDDY "buddy"
+
+/**
+ * A snapshot of free memory: the number of `free_units`, the number of holes (or free blocks) they are split into,
+ * and the size of the `largest` hole. External fragmentation is 1 - `largest`/`free_units`.
+*/
+typedef struct mem_stats{
+    long size;
+    long free_units;
+    long n_holes;
+    long largest;
+} mem_stats_t;
+
+/**
+ * A memory allocation strategy, as a table of functions over the strategy's own free-space structure `state`.
+ * `new_state` creates the structure for `size` allocation units, `allocate` returns the starting address of
+ * `mem_req` units or a negative value if they cannot be allocated, `free` returns them, `stats` fills in a snapshot of
+ * free memory, and `free_state` frees the structure.
+*/
+typedef struct mem_strategy{
+    const char *name;
+    void *(*new_state)(int size);
+    int (*allocate)(void *state, int mem_req);
+    void (*free)(void *state, int address, int mem_req);
+    void (*stats)(void *state, mem_stats_t *stats);
+    void (*free_state)(void *state);
+} mem_strategy_t;
+
+/**
+ * Simulates `size` allocation units of memory, managed by `strategy` through its free-space structure `state`.
+*/
 typedef struct memory{
-    char mem_array[MEM_SIZE];
+    const mem_strategy_t *strategy;
+    void *state;
+    int size;
 } memory_t;
 
-// Allocates memory for a new dynamic array, and returns a pointer to it
-memory_t *new_mem_array();
+// Returns the memory allocation strategy called `name` implemented on `backend`, or NULL if there is none
+const mem_strategy_t *find_mem_strategy(const char *name, int backend);
+
+// Allocates memory for a new memory_t of `size` allocation units managed by `strategy`, with all allocation units
+// initially free, and returns a pointer to it
+memory_t *new_mem_array(const mem_strategy_t *strategy, int size);
+
+// Simulates memory allocation of `mem_req` units for a process in the `input` queue before it is moved to the `ready`
+// queue, using the memory allocation strategy of `memory`. Returns the starting address, or `INIT_ADDR` on failure.
+int mem_allocate(memory_t *memory, int mem_req);
+
+// Simulates memory deallocation by returning the `mem_req` units starting at `address`, previously allocated to a 
+// process, to `memory`
+void deallocate(memory_t *memory, int address, int mem_req);
 
-// Implementation of the Best Fit memory allocation algorithm, for simulating memory allocation for processes in the 
-// `input` queue before moving them to the `ready` queue
-int allocate_best_fit(memory_t *memory, process_t *process);
+// Fills in `stats` with a snapshot of the free memory in `memory`
+void mem_stats(memory_t *memory, mem_stats_t *stats);
 
-// Simulates memory deallocation by updating the memory addresses previously allocated to a `process` to `FREE`
-void deallocate(memory_t *memory, process_t *process);
+// Frees all memory used by `memory`
+void free_mem_array(memory_t *memory);
 
-#endif
\ No newline at end of file
+#endif
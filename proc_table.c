@@ -0,0 +1,100 @@
+/**
+ * Implementation of `proc_table_t`, the structure of arrays holding every process of the simulation.
+*/
+#include "proc_table.h"
+
+/**
+ * Reallocates every column of `table` to hold `capacity` processes, and threads the new ids onto the free list in
+ * ascending order.
+*/
+static void grow_table(proc_table_t *table, uint32_t capacity){
+    table->time_arr = (unsigned int *)realloc(table->time_arr, sizeof(unsigned int)*capacity);
+    table->serv_time = (long *)realloc(table->serv_time, sizeof(long)*capacity);
+    table->serv_time_remaining = (long *)realloc(table->serv_time_remaining, sizeof(long)*capacity);
+    table->mem_req = (int *)realloc(table->mem_req, sizeof(int)*capacity);
+    table->mem_addr = (int *)realloc(table->mem_addr, sizeof(int)*capacity);
+    table->processes = (process_t *)realloc(table->processes, sizeof(process_t)*capacity);
+    table->next_free = (proc_id_t *)realloc(table->next_free, sizeof(proc_id_t)*capacity);
+    assert(table->time_arr && table->serv_time && table->serv_time_remaining && table->mem_req && table->mem_addr
+           && table->processes && table->next_free);
+
+    for (uint32_t id = table->capacity; id < capacity-1; id++){
+        table->next_free[id] = id+1;
+    }
+    table->next_free[capacity-1] = table->free_list;
+    table->free_list = table->capacity;
+    table->capacity = capacity;
+}
+
+/**
+ * Allocates memory for a new process table `table` with room for `INIT_PROCS` processes, and returns a pointer to it.
+*/
+proc_table_t *new_proc_table(){
+    proc_table_t *table = (proc_table_t *)malloc(sizeof(proc_table_t));
+    assert(table);
+    table->capacity = 0;
+    table->size = 0;
+    table->free_list = NO_PROC;
+    table->time_arr = NULL;
+    table->serv_time = NULL;
+    table->serv_time_remaining = NULL;
+    table->mem_req = NULL;
+    table->mem_addr = NULL;
+    table->processes = NULL;
+    table->next_free = NULL;
+    grow_table(table, INIT_PROCS);
+    return table;
+}
+
+/**
+ * Adds a process to `table` and returns its id, reusing the id of the most recently finished process if there is 
+ * one. Otherwise, every column is reallocated to `PROC_REALLOC_SCALE` times its capacity first. The fields of the 
+ * process are left for the caller to fill in.
+*/
+proc_id_t new_process(proc_table_t *table){
+    if (table->free_list == NO_PROC){
+        assert(table->capacity <= NO_PROC/PROC_REALLOC_SCALE);
+        grow_table(table, table->capacity*PROC_REALLOC_SCALE);
+    }
+    proc_id_t id = table->free_list;
+    table->free_list = table->next_free[id];
+    table->size++;
+    return id;
+}
+
+/**
+ * Removes the process `id` from `table`, putting its id at the head of the free list so that it is the next to be 
+ * reused while its columns are still in cache.
+*/
+void free_process(proc_table_t *table, proc_id_t id){
+    table->next_free[id] = table->free_list;
+    table->free_list = id;
+    table->size--;
+}
+
+/**
+ * Orders processes for the Shortest Job First scheduling algorithm in ascending order, by service time, arrival time,
+ * and name. Returns a negative value if `id_1` comes first, a positive value if `id_2` comes first, and 0 otherwise.
+ * Only ties on both service time and arrival time look at the cold names.
+*/
+int compare_processes(proc_table_t *table, proc_id_t id_1, proc_id_t id_2){
+    if (table->serv_time[id_1] != table->serv_time[id_2]){
+        return table->serv_time[id_1] < table->serv_time[id_2] ? -1 : 1;
+    }
+    if (table->time_arr[id_1] != table->time_arr[id_2]){
+        return table->time_arr[id_1] < table->time_arr[id_2] ? -1 : 1;
+    }
+    return strcmp(table->processes[id_1].name, table->processes[id_2].name);
+}
+
+// Frees all memory used by `table`.
+void free_proc_table(proc_table_t *table){
+    free(table->time_arr);
+    free(table->serv_time);
+    free(table->serv_time_remaining);
+    free(table->mem_req);
+    free(table->mem_addr);
+    free(table->processes);
+    free(table->next_free);
+    free(table);
+}
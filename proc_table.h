@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include <string.h>
+#include "channel.h"
+
+#ifndef __PROC_TABLE_H__
+#define __PROC_TABLE_H__
+
+// The maximum length of process names
+#define MAX_NAME_LEN 9
+// Read and write sides for the file descriptor array
+#define READ_WRITE 2
+// The initial number of processes the table has room for
+#define INIT_PROCS 64
+// The scale by which the columns of the table are dynamically reallocated
+#define PROC_REALLOC_SCALE 2
+// Marks the absence of a process, such as when there is no running process
+#define NO_PROC UINT32_MAX
+
+// Processes are identified by their index in the process table
+typedef uint32_t proc_id_t;
+
+// Used for real processes without a pidfd
+#define NO_PIDFD -1
+
+/**
+ * The cold fields of a process, which are only needed to talk to its real process: its unique `name`, `pid`, the 
+ * process id of the real process, and `fd_1`/`fd_2`, the arrays of file descriptors used for allowing two-way 
+ * communication between parent and child processes with pipe(), or `channel` in their place if it is not NULL. When 
+ * the real process is watched by an event loop,
+ * `pidfd` refers to it, or is `NO_PIDFD` otherwise, `waiting` holds the events still awaited from it, and `echo` is
+ * the byte it is expected to echo.
+*/
+typedef struct process{
+    char name[MAX_NAME_LEN];
+    int pid;
+    int fd_1[READ_WRITE], fd_2[READ_WRITE];
+    channel_t *channel;
+    int pidfd;
+    int waiting;
+    uint8_t echo;
+} process_t;
+
+/**
+ * Every process in the simulation, kept as a structure of arrays indexed by process id. The hot fields read by the
+ * scheduler and by memory allocation each have their own contiguous column: the arrival time `time_arr`, service time
+ * `serv_time`, the service time remaining after each cycle `serv_time_remaining`, the memory requirement `mem_req`,
+ * and `mem_addr`, the memory address that the allocation for a process starts at. The cold fields are kept apart in
+ * `processes`. Ids of finished processes are reused, most recent first, through `next_free`, starting at `free_list`.
+ * `capacity` is the number of processes each column has room for, and `size` is the number of live processes.
+*/
+typedef struct proc_table{
+    uint32_t capacity;
+    uint32_t size;
+    proc_id_t free_list;
+    unsigned int *time_arr;
+    long *serv_time;
+    long *serv_time_remaining;
+    int *mem_req;
+    int *mem_addr;
+    process_t *processes;
+    proc_id_t *next_free;
+} proc_table_t;
+
+// Allocates memory for a new, empty process table `table`, and returns a pointer to it
+proc_table_t *new_proc_table();
+
+// Adds a process to `table`, dynamically reallocating its columns if it is full, and returns its id. The fields of 
+// the process are left for the caller to fill in.
+proc_id_t new_process(proc_table_t *table);
+
+// Removes the process `id` from `table`, so that its id can be reused
+void free_process(proc_table_t *table, proc_id_t id);
+
+// Orders processes `id_1` and `id_2` of `table` for the SJF scheduling algorithm by service time, arrival time, and
+// name. Returns a negative value if `id_1` comes first, a positive value if `id_2` comes first, and 0 if they are the
+// same process.
+int compare_processes(proc_table_t *table, proc_id_t id_1, proc_id_t id_2);
+
+// Frees all memory used by `table`
+void free_proc_table(proc_table_t *table);
+
+#endif
@@ -9,33 +9,70 @@
 */
 
 #define _POSIX_C_SOURCE 1
+#define _DEFAULT_SOURCE
 
 #include <err.h>
 #include <getopt.h>
+#include <linux/futex.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/file.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <sys/signalfd.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 
+#include "channel.h"
+
 static long pid = 0;
 static int verbose_flag = 0;
+static int pool_flag = 0;
+static int shm_flag = 0;
 typedef enum { STOP = 1, CONTINUE = 2, TERM = 3, START = 0 } Op;
 
+/* Reads a length byte then that many bytes of name, returns 0 on EOF */
+int read_process_name(char process_name[256]) {
+	uint8_t name_len;
+	ssize_t n;
+	size_t len = 0;
+
+	n = read(STDIN_FILENO, &name_len, 1);
+	if (n < 0) {
+		err(EXIT_FAILURE, "read");
+	}
+	if (n == 0) {
+		return 0;
+	}
+	while (len < name_len) {
+		n = read(STDIN_FILENO, process_name + len, name_len - len);
+		if (n <= 0) {
+			err(EXIT_FAILURE, "read");
+		}
+		len += n;
+	}
+	process_name[len] = '\0';
+	return 1;
+}
+
 void read_store_dword(Op op, uint8_t hash_content[128], size_t* dest_index);
 void store_process_name(const char* process_name, uint8_t hash_content[128],
 						size_t* dest_index);
+int read_process_name(char process_name[256]);
+void serve_channel(uint8_t hash_content[128], size_t* dest_index);
 void sha256_hash(char hash_hexstring[65], const uint8_t* buf,
 				 const uint64_t nbyte);
 
 int main(int argc, char* argv[]) {
 	int c;
 	char* process_name;
+	char pooled_name[256];
 	static struct option long_options[] = {
 		{"verbose", no_argument, &verbose_flag, 1},
+		{"pool", no_argument, &pool_flag, 1},
+		{"shm", no_argument, &shm_flag, 1},
 		{"help", no_argument, 0, 'h'},
 		{0, 0, 0, 0}};
 	int option_index;
@@ -60,7 +97,10 @@ int main(int argc, char* argv[]) {
 		case 0: break;
 		case 'v': verbose_flag = 1; break;
 		case 'h':
-			printf("Usage: %s [-v|--verbose] <process-name>\n", argv[0]);
+			printf("Usage: %s [-v|--verbose] <process-name>\n"
+				   "       %s [-v|--verbose] --pool\n"
+				   "       %s [-v|--verbose] --shm <process-name>\n",
+				   argv[0], argv[0], argv[0]);
 			exit(EXIT_SUCCESS);
 		}
 	}
@@ -68,17 +108,30 @@ int main(int argc, char* argv[]) {
 	if (verbose_flag) {
 		fprintf(stderr, "[process.c (%ld)] ppid: %ld\n", pid, (long)getppid());
 	}
-	if (optind + 1 != argc) {
+	if (optind + !pool_flag != argc) {
 		fprintf(stderr,
 				"[process.c] Error: Less or more arguments than expected\n");
 		exit(EXIT_FAILURE);
 	}
-	process_name = argv[optind++];
+	/* A pooled process is sent each name on stdin, and exits on EOF */
+	if (pool_flag) {
+		process_name = pooled_name;
+		if (!read_process_name(process_name)) {
+			exit(EXIT_SUCCESS);
+		}
+	} else {
+		process_name = argv[optind++];
+	}
 
 	memset(sha_content, 0, 128);
 	dest_index = 0;
 	store_process_name(process_name, sha_content, &dest_index);
 
+	/* Messages come through shared memory instead of signals and stdin */
+	if (shm_flag) {
+		serve_channel(sha_content, &dest_index);
+	}
+
 	sigemptyset(&mask);
 	sigaddset(&mask, SIGINT);
 	sigaddset(&mask, SIGTERM);
@@ -102,7 +155,27 @@ int main(int argc, char* argv[]) {
 			err(EXIT_FAILURE, "read");
 		}
 
-		if (fdsi.ssi_signo == SIGINT || fdsi.ssi_signo == SIGTERM) {
+		if (pool_flag &&
+			(fdsi.ssi_signo == SIGINT || fdsi.ssi_signo == SIGTERM)) {
+			/* Same as below, but stay alive and start over with a new name */
+			if (verbose_flag) {
+				fprintf(stderr,
+						"[process.c (%ld)] handling SIGINT or SIGTERM\n", pid);
+			}
+			read_store_dword(TERM, sha_content, &dest_index);
+
+			sha256_hash(hash, sha_content, 128 - 9);
+			printf("%s\n", hash);
+			fflush(stdout);
+
+			if (!read_process_name(process_name)) {
+				exit(EXIT_SUCCESS);
+			}
+			memset(sha_content, 0, 128);
+			dest_index = 0;
+			store_process_name(process_name, sha_content, &dest_index);
+			read_store_dword(START, sha_content, &dest_index);
+		} else if (fdsi.ssi_signo == SIGINT || fdsi.ssi_signo == SIGTERM) {
 			sigemptyset(&mask);
 			sigaddset(&mask, SIGINT);
 			sigaddset(&mask, SIGTERM);
@@ -169,6 +242,55 @@ void store_process_name(const char* process_name, uint8_t hash_content[128],
 		  dest_index);
 }
 
+/* Handles channel messages like read_store_dword, until TERM */
+void serve_channel(uint8_t hash_content[128], size_t* dest_index) {
+	channel_t* channel;
+	uint32_t received = 0, sent, slot;
+	uint8_t buf[5];
+	char hash[65];
+
+	channel = mmap(NULL, sizeof(channel_t), PROT_READ | PROT_WRITE,
+				   MAP_SHARED, STDIN_FILENO, 0);
+	if (channel == MAP_FAILED) {
+		err(EXIT_FAILURE, "mmap");
+	}
+
+	for (;;) {
+		while ((sent = atomic_load_explicit(&channel->sent,
+											memory_order_acquire)) ==
+			   received) {
+			syscall(SYS_futex, &channel->sent, FUTEX_WAIT, sent, NULL, NULL,
+					0);
+		}
+		slot = received % CHANNEL_SLOTS;
+		buf[0] = channel->op[slot];
+		memcpy(buf + 1, channel->time[slot], 4);
+
+		if (verbose_flag) {
+			fprintf(stderr,
+					"[process.c (%ld)] op %d, hex bytes [%02x, %02x, %02x, "
+					"%02x] from channel\n",
+					pid, buf[0], buf[1], buf[2], buf[3], buf[4]);
+		}
+		store(buf, 5, hash_content, dest_index);
+
+		if (buf[0] == START || buf[0] == CONTINUE) {
+			channel->echo = buf[4];
+		} else if (buf[0] == TERM) {
+			sha256_hash(hash, hash_content, 128 - 9);
+			memcpy(channel->sha, hash, 65);
+		}
+
+		received++;
+		atomic_store_explicit(&channel->received, received,
+							  memory_order_release);
+		syscall(SYS_futex, &channel->received, FUTEX_WAKE, 1, NULL, NULL, 0);
+		if (buf[0] == TERM) {
+			exit(EXIT_SUCCESS);
+		}
+	}
+}
+
 void read_store_dword(Op op, uint8_t hash_content[128], size_t* dest_index) {
 	uint8_t buf[5];
 	size_t len, n;
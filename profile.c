@@ -0,0 +1,101 @@
+/**
+ * Implementation of the probes of a build with -DPROFILE, which time the phases of the simulation into a histogram
+ * each. The probes are global, as the phases they time are spread across the simulation, and are only ever hit from
+ * the thread running it.
+*/
+#include "profile.h"
+
+#ifdef PROFILE
+
+// The names of the probes, as printed
+static const char *probe_names[N_PROBES] = {
+    "simulation", "input_scan", "allocate_memory", "mem_allocate", "deallocate", "schedule",
+    "create_process", "resume_process", "suspend_process", "terminate_process"
+};
+
+static probe_t probes[N_PROBES];
+
+/**
+ * Returns the current monotonic time in ns. clock_gettime() is served from the vDSO, so this does not enter the 
+ * kernel.
+*/
+long profile_now(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1000000000L + ts.tv_nsec;
+}
+
+/**
+ * Returns the histogram bucket of a time of `ns` ns: the time itself under `PROFILE_EXACT`, and otherwise its power of
+ * two and the next 3 bits below the highest.
+*/
+static int bucket(long ns){
+    if (ns < PROFILE_EXACT){
+        return ns < 0 ? 0 : (int)ns;
+    }
+    int power = 63-__builtin_clzl((unsigned long)ns);
+    int sub = (int)(ns >> (power-3)) & (PROFILE_SUB_BUCKETS-1);
+    return PROFILE_EXACT + (power-4)*PROFILE_SUB_BUCKETS + sub;
+}
+
+/**
+ * Returns the longest time in ns that falls in bucket `b`.
+*/
+static long bucket_limit(int b){
+    if (b < PROFILE_EXACT){
+        return b;
+    }
+    int power = (b-PROFILE_EXACT)/PROFILE_SUB_BUCKETS + 4;
+    long sub = (b-PROFILE_EXACT) % PROFILE_SUB_BUCKETS;
+    return ((PROFILE_SUB_BUCKETS+sub+1) << (power-3)) - 1;
+}
+
+/**
+ * Records a call of `probe` that started at `start` and has just ended.
+*/
+void profile_record(int probe, long start){
+    long ns = profile_now()-start;
+    probe_t *p = &probes[probe];
+    p->calls++;
+    p->total_ns += ns;
+    if (ns > p->max_ns){
+        p->max_ns = ns;
+    }
+    p->buckets[bucket(ns)]++;
+}
+
+/**
+ * Returns the time in ns that `fraction` of the calls of `p` took at most, to the limit of its bucket.
+*/
+static long percentile(probe_t *p, double fraction){
+    long rank = (long)(fraction*p->calls);
+    long seen = 0;
+    for (int b = 0; b < PROFILE_BUCKETS; b++){
+        seen += p->buckets[b];
+        if (seen > rank){
+            return bucket_limit(b) < p->max_ns ? bucket_limit(b) : p->max_ns;
+        }
+    }
+    return p->max_ns;
+}
+
+/**
+ * Prints one line for each probe with any calls to `out`: the number of calls, their total time in ms, their mean, 
+ * median, 90th and 99th percentile and longest times in ns, and the share of the whole simulation they took. Probes
+ * nest inside `PROBE_SIMULATION`, and `PROBE_MEM_ALLOCATE` inside `PROBE_ALLOCATE_MEMORY`, so shares can add up to
+ * more than 100%.
+*/
+void print_profile(FILE *out){
+    long simulation_ns = probes[PROBE_SIMULATION].total_ns;
+    for (int i = 0; i < N_PROBES; i++){
+        probe_t *p = &probes[i];
+        if (p->calls == 0){
+            continue;
+        }
+        fprintf(out, "Profile %s calls %ld total %.3f ms mean %.0f ns p50 %ld ns p90 %ld ns p99 %ld ns max %ld ns share %.1f%%\n",
+            probe_names[i], p->calls, p->total_ns/1e6, p->total_ns/(double)p->calls, percentile(p, 0.5), 
+            percentile(p, 0.9), percentile(p, 0.99), p->max_ns, simulation_ns > 0 ? 100.0*p->total_ns/simulation_ns : 0);
+    }
+}
+
+#endif
@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+// Probes, each timing one phase of the simulation. `PROBE_SIMULATION` times the whole of it, which the share of every
+// other probe is taken of.
+#define PROBE_SIMULATION 0
+#define PROBE_INPUT_SCAN 1
+#define PROBE_ALLOCATE_MEMORY 2
+#define PROBE_MEM_ALLOCATE 3
+#define PROBE_DEALLOCATE 4
+#define PROBE_SCHEDULE 5
+#define PROBE_CREATE_PROCESS 6
+#define PROBE_RESUME_PROCESS 7
+#define PROBE_SUSPEND_PROCESS 8
+#define PROBE_TERMINATE_PROCESS 9
+#define N_PROBES 10
+
+// The number of buckets of the histogram of each probe's times. Times under `PROFILE_EXACT` ns have a bucket each, 
+// and each power of two above that is split into `PROFILE_SUB_BUCKETS`, so a percentile is within 1/8 of the time.
+#define PROFILE_EXACT 16
+#define PROFILE_SUB_BUCKETS 8
+#define PROFILE_BUCKETS 512
+
+/**
+ * Probes are only compiled in when building with -DPROFILE, as `allocate_profile` and `allocate_sim` are. Otherwise
+ * PROFILE_BEGIN() and PROFILE_END() expand to nothing, and the build pays nothing for them.
+*/
+#ifdef PROFILE
+
+/**
+ * What a probe has timed: the number of `calls`, their total and longest times in ns, and a histogram of the times
+ * in `buckets`.
+*/
+typedef struct probe{
+    long calls;
+    long total_ns;
+    long max_ns;
+    long buckets[PROFILE_BUCKETS];
+} probe_t;
+
+// Starts timing a phase, keeping the start time in the new variable `start`
+#define PROFILE_BEGIN(start) long start = profile_now()
+// Stops timing a phase started at `start`, and records it in `probe`
+#define PROFILE_END(probe, start) profile_record(probe, start)
+
+// Returns the current monotonic time in ns
+long profile_now();
+
+// Records a call of `probe` that started at `start`
+void profile_record(int probe, long start);
+
+// Prints the number of calls and total, mean, percentile and longest times of every probe, and its share of 
+// `PROBE_SIMULATION`, to `out`
+void print_profile(FILE *out);
+
+#else
+
+#define PROFILE_BEGIN(start)
+#define PROFILE_END(probe, start)
+
+#endif
+
+#endif
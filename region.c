@@ -0,0 +1,36 @@
+/**
+ * Implementation of zero-filled regions used for the per-unit arrays of simulated memory, which can be large.
+*/
+#include "region.h"
+
+/**
+ * Allocates a zero-filled region of `bytes` bytes and returns a pointer to it. Regions of at least `REGION_MMAP_MIN`
+ * bytes are backed by an anonymous private mapping, whose pages are only committed once they are first written.
+*/
+void *new_region(size_t bytes){
+    if (bytes < REGION_MMAP_MIN){
+        void *region = calloc(1, bytes);
+        if (region == NULL){
+            perror("calloc");
+            exit(EXIT_FAILURE);
+        }
+        return region;
+    }
+
+    void *region = mmap(NULL, bytes, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+    if (region == MAP_FAILED){
+        perror("mmap");
+        exit(EXIT_FAILURE);
+    }
+    return region;
+}
+
+// Frees a region of `bytes` bytes previously returned by new_region().
+void free_region(void *region, size_t bytes){
+    if (bytes < REGION_MMAP_MIN){
+        free(region);
+    }
+    else {
+        munmap(region, bytes);
+    }
+}
@@ -0,0 +1,18 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#ifndef __REGION_H__
+#define __REGION_H__
+
+// Regions of at least this many bytes are backed by an anonymous mmap() rather than the heap
+#define REGION_MMAP_MIN (1 << 20)
+
+// Allocates a zero-filled region of `bytes` bytes and returns a pointer to it. Large regions are mapped lazily, so 
+// pages that are never written cost nothing.
+void *new_region(size_t bytes);
+
+// Frees a region of `bytes` bytes previously returned by new_region()
+void free_region(void *region, size_t bytes);
+
+#endif
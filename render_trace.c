@@ -0,0 +1,239 @@
+/**
+ * Renders a binary trace written by "allocate --trace-format=binary" back into the text transcript, exactly as
+ * "allocate" would have printed it. Usage: ./render_trace <trace-file>
+*/
+#define _GNU_SOURCE
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "trace.h"
+#include "transcript.h"
+
+// The number of process names there is room for at first, doubled whenever an id does not fit
+#define INIT_NAMES 64
+
+/**
+ * The process names of a trace, indexed by process id, with room for `capacity` of them.
+*/
+typedef struct names{
+    uint32_t capacity;
+    char (*name)[MAX_NAME_LEN];
+} names_t;
+
+/**
+ * Records that process `id` is called by the `len` bytes at `name` in `names`, growing it if `id` does not fit.
+*/
+static void set_name(names_t *names, proc_id_t id, const uint8_t *name, uint64_t len){
+    if (len >= MAX_NAME_LEN){
+        fprintf(stderr, "Error: the name of process %u is too long\n", id);
+        exit(EXIT_FAILURE);
+    }
+    while (id >= names->capacity){
+        names->capacity *= 2;
+        names->name = realloc(names->name, MAX_NAME_LEN*names->capacity);
+        assert(names->name);
+    }
+    memset(names->name[id], 0, MAX_NAME_LEN);
+    memcpy(names->name[id], name, len);
+}
+
+/**
+ * Returns the name of process `id` in `names`, which must have been set.
+*/
+static const char *get_name(names_t *names, proc_id_t id){
+    if (id >= names->capacity){
+        fprintf(stderr, "Error: process %u has no name\n", id);
+        exit(EXIT_FAILURE);
+    }
+    return names->name[id];
+}
+
+/**
+ * The bytes of a trace still to be read, from `p` up to `end`.
+*/
+typedef struct reader{
+    const uint8_t *p;
+    const uint8_t *end;
+} reader_t;
+
+/**
+ * Returns a pointer to the next `n` bytes of `reader`, and skips past them.
+*/
+static const uint8_t *get_bytes(reader_t *reader, size_t n){
+    if ((size_t)(reader->end-reader->p) < n){
+        fprintf(stderr, "Error: trace ends in the middle of a record\n");
+        exit(EXIT_FAILURE);
+    }
+    const uint8_t *bytes = reader->p;
+    reader->p += n;
+    return bytes;
+}
+
+/**
+ * Returns the next varint of `reader`.
+*/
+static uint64_t get_varint(reader_t *reader){
+    uint64_t value = 0;
+    for (int shift = 0; shift < 7*TRACE_MAX_VARINT; shift += 7){
+        uint8_t byte = *get_bytes(reader, 1);
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)){
+            return value;
+        }
+    }
+    fprintf(stderr, "Error: varint longer than %d bytes\n", TRACE_MAX_VARINT);
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * Returns the double held by the next 8 bytes of `reader`.
+*/
+static double get_double(reader_t *reader){
+    double d;
+    memcpy(&d, get_bytes(reader, sizeof(d)), sizeof(d));
+    return d;
+}
+
+/**
+ * Writes the line for the event of `type` at `time`, about a process called `name`, to `transcript`. `value` and `cpu`
+ * are as described in "trace.h", and FINISHED-PROCESS takes its raw sha bytes from `digest`.
+*/
+static void render_event(transcript_t *transcript, int type, long time, const char *name, long value, long cpu, const uint8_t *digest){
+    static const char hex[] = "0123456789abcdef";
+    transcript_long(transcript, time);
+    if (type == TRACE_READY){
+        transcript_str(transcript, ",READY,process_name=");
+        transcript_str(transcript, name);
+        transcript_str(transcript, ",assigned_at=");
+        transcript_long(transcript, value);
+    }
+    else if (type == TRACE_RUNNING){
+        transcript_str(transcript, ",RUNNING,process_name=");
+        transcript_str(transcript, name);
+        transcript_str(transcript, ",remaining_time=");
+        transcript_long(transcript, value);
+        if (cpu != TRACE_NO_CPU){
+            transcript_str(transcript, ",cpu=");
+            transcript_long(transcript, cpu);
+        }
+    }
+    else if (type == TRACE_FINISHED){
+        transcript_str(transcript, ",FINISHED,process_name=");
+        transcript_str(transcript, name);
+        transcript_str(transcript, ",proc_remaining=");
+        transcript_long(transcript, value);
+    }
+    else {
+        char sha[2*TRACE_SHA_BYTES+1];
+        for (int i = 0; i < TRACE_SHA_BYTES; i++){
+            sha[2*i] = hex[digest[i] >> 4];
+            sha[2*i+1] = hex[digest[i] & 0xf];
+        }
+        sha[2*TRACE_SHA_BYTES] = '\0';
+        transcript_str(transcript, ",FINISHED-PROCESS,process_name=");
+        transcript_str(transcript, name);
+        transcript_str(transcript, ",sha=");
+        transcript_str(transcript, sha);
+    }
+    transcript_end_line(transcript);
+}
+
+/**
+ * Renders the records of a trace left in `reader` to `transcript`, adding the time in the tag of each record to the
+ * time of the one before.
+*/
+static void render(transcript_t *transcript, reader_t *reader){
+    names_t names = {INIT_NAMES, malloc(MAX_NAME_LEN*INIT_NAMES)};
+    assert(names.name);
+    long time = 0;
+    double overhead_max = 0;
+
+    while (reader->p < reader->end){
+        uint64_t tag = get_varint(reader);
+        int type = (int)(tag & ((1 << TRACE_TYPE_BITS)-1));
+        time += (long)(tag >> TRACE_TYPE_BITS);
+        proc_id_t id;
+        long value, cpu;
+        switch (type){
+            case TRACE_NAME:
+                id = (proc_id_t)get_varint(reader);
+                value = (long)get_varint(reader);
+                set_name(&names, id, get_bytes(reader, value), value);
+                break;
+            case TRACE_FINISHED_PROCESS:
+                id = (proc_id_t)get_varint(reader);
+                render_event(transcript, type, time, get_name(&names, id), 0, 0, get_bytes(reader, TRACE_SHA_BYTES));
+                break;
+            case TRACE_READY:
+            case TRACE_RUNNING:
+            case TRACE_FINISHED:
+                id = (proc_id_t)get_varint(reader);
+                value = (long)get_varint(reader);
+                cpu = type == TRACE_RUNNING ? (long)get_varint(reader)-1 : 0;
+                render_event(transcript, type, time, get_name(&names, id), value, cpu, NULL);
+                break;
+            case TRACE_TURNAROUND:
+                transcript_printf(transcript, "Turnaround time %.0f\n", get_double(reader));
+                break;
+            case TRACE_OVERHEAD_MAX:
+                overhead_max = get_double(reader);
+                break;
+            case TRACE_OVERHEAD_MEAN:
+                transcript_printf(transcript, "Time overhead %.2f %.2f\n", overhead_max, get_double(reader));
+                break;
+            case TRACE_MAKESPAN:
+                get_varint(reader);
+                transcript_printf(transcript, "Makespan %ld\n", (long)get_varint(reader));
+                break;
+            case TRACE_UTILISATION:
+                cpu = (long)get_varint(reader);
+                transcript_printf(transcript, "CPU %ld utilisation %.2f\n", cpu, get_double(reader));
+                break;
+            default:
+                fprintf(stderr, "Error: unknown record type %d\n", type);
+                exit(EXIT_FAILURE);
+        }
+    }
+    free(names.name);
+}
+
+int main(int argc, char *argv[]){
+    if (argc != 2){
+        fprintf(stderr, "Usage: %s <trace-file>\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    int fd = open(argv[1], O_RDONLY);
+    struct stat st;
+    if (fd == -1 || fstat(fd, &st) == -1){
+        perror(argv[1]);
+        exit(EXIT_FAILURE);
+    }
+    size_t size = st.st_size;
+    trace_header_t header;
+    if (size < sizeof(header)){
+        fprintf(stderr, "Error: %s is not a trace\n", argv[1]);
+        exit(EXIT_FAILURE);
+    }
+    char *map = (char *)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED){
+        perror("mmap");
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+
+    memcpy(&header, map, sizeof(header));
+    if (memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) != 0 || header.version != TRACE_VERSION){
+        fprintf(stderr, "Error: %s is not a version %d trace\n", argv[1], TRACE_VERSION);
+        exit(EXIT_FAILURE);
+    }
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    transcript_t *transcript = new_transcript(STDOUT_FILENO, 0);
+    reader_t reader = {(const uint8_t *)map+sizeof(header), (const uint8_t *)map+size};
+    render(transcript, &reader);
+    free_transcript(transcript);
+    munmap(map, size);
+    return 0;
+}
@@ -0,0 +1,202 @@
+/**
+ * Implementation of the lock-free rings of process ids that connect threads: `spsc_ring_t` for one producer and one
+ * consumer, and `mpsc_ring_t` for many producers and one consumer.
+*/
+#define _GNU_SOURCE
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include "ring.h"
+
+/**
+ * Sleeps until `word` is no longer `value`, or a wake-up. May return early, so callers check `word` again.
+*/
+static void futex_wait(_Atomic uint32_t *word, uint32_t value){
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+}
+
+/**
+ * Wakes the thread sleeping on `word`, if any.
+*/
+static void futex_wake(_Atomic uint32_t *word){
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+/**
+ * Returns the smallest power of two that is at least `capacity`.
+*/
+static uint32_t ring_capacity(uint32_t capacity){
+    uint32_t power = 1;
+    while (power < capacity){
+        power *= 2;
+    }
+    return power;
+}
+
+/**
+ * Allocates memory for a new single-producer/single-consumer ring with room for `capacity` processes rounded up to a
+ * power of two, and returns a pointer to it. The ring is aligned to a cache line, so that its padding does its job.
+*/
+spsc_ring_t *new_spsc_ring(uint32_t capacity){
+    spsc_ring_t *ring = (spsc_ring_t *)aligned_alloc(CACHE_LINE, sizeof(spsc_ring_t));
+    assert(ring);
+    ring->capacity = ring_capacity(capacity);
+    ring->processes = (proc_id_t *)malloc(sizeof(proc_id_t)*ring->capacity);
+    assert(ring->processes);
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->sleeping, 0);
+    ring->cached_head = 0;
+    ring->cached_tail = 0;
+    return ring;
+}
+
+/**
+ * Pushes process `id` onto `ring`. Must only be called from the producer thread. The consumer's `head` is only 
+ * reloaded, with acquire ordering so that its slot is known to have been read, when the ring looks full. The id is 
+ * written before `tail` is advanced with release ordering, which publishes it to the consumer. Returns 1 on success,
+ * and 0 if `ring` is full.
+*/
+int spsc_push(spsc_ring_t *ring, proc_id_t id){
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (tail - ring->cached_head == ring->capacity){
+        ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (tail - ring->cached_head == ring->capacity){
+            return 0;
+        }
+    }
+    ring->processes[tail&(ring->capacity-1)] = id;
+    atomic_store_explicit(&ring->tail, tail+1, memory_order_release);
+    return 1;
+}
+
+/**
+ * Pops the oldest process from `ring`, returning its id, or `NO_PROC` if `ring` is empty. Must only be called from the
+ * consumer thread. The producer's `tail` is only reloaded, with acquire ordering so that the ids before it are 
+ * visible, when the ring looks empty. `head` is advanced with release ordering once the id has been read, handing the
+ * slot back to the producer.
+*/
+proc_id_t spsc_pop(spsc_ring_t *ring){
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (head == ring->cached_tail){
+        ring->cached_tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if (head == ring->cached_tail){
+            return NO_PROC;
+        }
+    }
+    proc_id_t id = ring->processes[head&(ring->capacity-1)];
+    atomic_store_explicit(&ring->head, head+1, memory_order_release);
+    return id;
+}
+
+/**
+ * Pops the oldest process from `ring`, returning its id, and sleeps on `tail` for as long as `ring` is empty. Must only
+ * be called from the consumer thread. `sleeping` is set before `tail` is checked again, with a full fence between
+ * them that pairs with the one in spsc_push_wake(), so either the producer sees `sleeping` and wakes the consumer, or
+ * the consumer sees the pushed process and does not sleep.
+*/
+proc_id_t spsc_pop_wait(spsc_ring_t *ring){
+    proc_id_t id;
+    while ((id = spsc_pop(ring)) == NO_PROC){
+        atomic_store_explicit(&ring->sleeping, 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        if (tail == atomic_load_explicit(&ring->head, memory_order_relaxed)){
+            futex_wait(&ring->tail, tail);
+        }
+        atomic_store_explicit(&ring->sleeping, 0, memory_order_relaxed);
+    }
+    return id;
+}
+
+/**
+ * Pushes process `id` onto `ring`, which must not be full, then wakes the consumer if it is asleep in 
+ * spsc_pop_wait(). Must only be called from the producer thread.
+*/
+void spsc_push_wake(spsc_ring_t *ring, proc_id_t id){
+    int pushed = spsc_push(ring, id);
+    assert(pushed);
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&ring->sleeping, memory_order_relaxed)){
+        futex_wake(&ring->tail);
+    }
+}
+
+// Frees all memory used by `ring`.
+void free_spsc_ring(spsc_ring_t *ring){
+    free(ring->processes);
+    free(ring);
+}
+
+/**
+ * Allocates memory for a new multi-producer/single-consumer ring with room for `capacity` processes rounded up to a 
+ * power of two, and returns a pointer to it. The slot at each position starts out free for the first producer to 
+ * reach it.
+*/
+mpsc_ring_t *new_mpsc_ring(uint32_t capacity){
+    mpsc_ring_t *ring = (mpsc_ring_t *)aligned_alloc(CACHE_LINE, sizeof(mpsc_ring_t));
+    assert(ring);
+    ring->capacity = ring_capacity(capacity);
+    ring->slots = (ring_slot_t *)malloc(sizeof(ring_slot_t)*ring->capacity);
+    assert(ring->slots);
+    for (uint32_t i = 0; i < ring->capacity; i++){
+        atomic_init(&ring->slots[i].sequence, i);
+    }
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    return ring;
+}
+
+/**
+ * Pushes process `id` onto `ring` from any producer thread. The producer claims the slot at `tail` by advancing 
+ * `tail` with a compare-and-swap, retrying from the new `tail` if another producer got there first, writes the id,
+ * and then releases the slot's sequence to the consumer. Returns 1 on success, and 0 if `ring` is full.
+*/
+int mpsc_push(mpsc_ring_t *ring, proc_id_t id){
+    uint32_t pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    ring_slot_t *slot;
+    while (1){
+        slot = &ring->slots[pos&(ring->capacity-1)];
+        uint32_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        int32_t diff = (int32_t)(sequence - pos);
+        if (diff == 0){
+            if (atomic_compare_exchange_weak_explicit(&ring->tail, &pos, pos+1, memory_order_relaxed, 
+                                                      memory_order_relaxed)){
+                break;
+            }
+        }
+        // The consumer has not freed this slot from the previous lap yet
+        else if (diff < 0){
+            return 0;
+        }
+        else {
+            pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        }
+    }
+    slot->id = id;
+    atomic_store_explicit(&slot->sequence, pos+1, memory_order_release);
+    return 1;
+}
+
+/**
+ * Pops the oldest published process from `ring`, returning its id, or `NO_PROC` if the slot at `head` has not been
+ * published yet. Must only be called from the consumer thread. The slot is handed to the producers of the next lap by
+ * releasing its sequence as `head` plus `capacity`.
+*/
+proc_id_t mpsc_pop(mpsc_ring_t *ring){
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    ring_slot_t *slot = &ring->slots[head&(ring->capacity-1)];
+    if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != head+1){
+        return NO_PROC;
+    }
+    proc_id_t id = slot->id;
+    atomic_store_explicit(&slot->sequence, head+ring->capacity, memory_order_release);
+    atomic_store_explicit(&ring->head, head+1, memory_order_relaxed);
+    return id;
+}
+
+// Frees all memory used by `ring`.
+void free_mpsc_ring(mpsc_ring_t *ring){
+    free(ring->slots);
+    free(ring);
+}
@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <assert.h>
+#include "proc_table.h"
+
+#ifndef __RING_H__
+#define __RING_H__
+
+// The size of a cache line, which the indexes written by different threads are kept apart by
+#define CACHE_LINE 64
+
+/**
+ * A lock-free ring of process ids for exactly one producer thread and one consumer thread. `head` is only written by
+ * the consumer and `tail` only by the producer, each on its own cache line. They count up forever and are wrapped
+ * into `processes` with a mask, as `capacity` is a power of two. Each side keeps a private copy of the other side's
+ * index, `cached_tail` and `cached_head`, and only reloads it when the ring looks empty or full, so the two cache
+ * lines are not bounced between cores on every operation. Process ids are published with release stores and picked
+ * up with acquire loads. `sleeping` is set while the consumer is asleep in spsc_pop_wait(), waiting on `tail`, so that 
+ * spsc_push_wake() only makes a system call to wake it when it has to.
+*/
+typedef struct spsc_ring{
+    _Alignas(CACHE_LINE) _Atomic uint32_t head;
+    uint32_t cached_tail;
+    _Alignas(CACHE_LINE) _Atomic uint32_t tail;
+    uint32_t cached_head;
+    _Alignas(CACHE_LINE) _Atomic uint32_t sleeping;
+    _Alignas(CACHE_LINE) uint32_t capacity;
+    proc_id_t *processes;
+} spsc_ring_t;
+
+/**
+ * A slot of an `mpsc_ring_t`, holding a process `id` and a `sequence` number saying whose turn it is to use the slot.
+*/
+typedef struct ring_slot{
+    _Atomic uint32_t sequence;
+    proc_id_t id;
+} ring_slot_t;
+
+/**
+ * A lock-free ring of process ids for any number of producer threads and one consumer thread. Producers claim a slot
+ * by advancing `tail` with a compare-and-swap, and then publish into it by releasing its `sequence`, so a slow 
+ * producer only holds up the consumer at its own slot. The consumer owns `head`. A slot at position `pos` is free for
+ * a producer when its sequence is `pos`, and full for the consumer when it is `pos+1`. `head` and `tail` are on 
+ * separate cache lines, and `capacity` is a power of two.
+*/
+typedef struct mpsc_ring{
+    _Alignas(CACHE_LINE) _Atomic uint32_t head;
+    _Alignas(CACHE_LINE) _Atomic uint32_t tail;
+    _Alignas(CACHE_LINE) uint32_t capacity;
+    ring_slot_t *slots;
+} mpsc_ring_t;
+
+// Allocates memory for a new, empty single-producer/single-consumer ring with room for at least `capacity` 
+// processes, and returns a pointer to it
+spsc_ring_t *new_spsc_ring(uint32_t capacity);
+
+// Pushes process `id` onto `ring` from the producer thread. Returns 1 on success, and 0 if `ring` is full.
+int spsc_push(spsc_ring_t *ring, proc_id_t id);
+
+// Pops the oldest process from `ring` on the consumer thread, returning its id, or `NO_PROC` if `ring` is empty
+proc_id_t spsc_pop(spsc_ring_t *ring);
+
+// Pops the oldest process from `ring` on the consumer thread, returning its id, and sleeps until the producer pushes
+// one if `ring` is empty
+proc_id_t spsc_pop_wait(spsc_ring_t *ring);
+
+// Pushes process `id` onto `ring` from the producer thread, which must have room for it, and wakes the consumer if it
+// is asleep in spsc_pop_wait()
+void spsc_push_wake(spsc_ring_t *ring, proc_id_t id);
+
+// Frees all memory used by `ring`
+void free_spsc_ring(spsc_ring_t *ring);
+
+// Allocates memory for a new, empty multi-producer/single-consumer ring with room for at least `capacity` processes,
+// and returns a pointer to it
+mpsc_ring_t *new_mpsc_ring(uint32_t capacity);
+
+// Pushes process `id` onto `ring` from any producer thread. Returns 1 on success, and 0 if `ring` is full.
+int mpsc_push(mpsc_ring_t *ring, proc_id_t id);
+
+// Pops the oldest published process from `ring` on the consumer thread, returning its id, or `NO_PROC` if there is 
+// none
+proc_id_t mpsc_pop(mpsc_ring_t *ring);
+
+// Frees all memory used by `ring`
+void free_mpsc_ring(mpsc_ring_t *ring);
+
+#endif
@@ -0,0 +1,190 @@
+/**
+ * Implementation of `trace_t`, which writes the transcript as variable-length binary records to a mapped file.
+*/
+#define _GNU_SOURCE
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "trace.h"
+
+// The path the file open on a descriptor can be reopened through
+#define FD_PATH "/proc/self/fd/%d"
+// The most bytes a record other than NAME can take: a tag, two varints and a digest
+#define MAX_RECORD (3*TRACE_MAX_VARINT+TRACE_SHA_BYTES)
+
+/**
+ * Grows the file of `trace` and its mapping to double their capacity.
+*/
+static void grow(trace_t *trace){
+    size_t capacity = trace->capacity*2;
+    if (ftruncate(trace->fd, capacity) == -1){
+        perror("ftruncate");
+        exit(EXIT_FAILURE);
+    }
+    trace->map = (char *)mremap(trace->map, trace->capacity, capacity, MREMAP_MAYMOVE);
+    if (trace->map == MAP_FAILED){
+        perror("mremap");
+        exit(EXIT_FAILURE);
+    }
+    trace->capacity = capacity;
+}
+
+/**
+ * Makes room for at least `n` more bytes in `trace`, and returns a pointer to where they go.
+*/
+static uint8_t *reserve(trace_t *trace, size_t n){
+    while (trace->size+n > trace->capacity){
+        grow(trace);
+    }
+    return (uint8_t *)trace->map+trace->size;
+}
+
+/**
+ * Writes `value` as a varint at `p`, and returns a pointer to the byte after it.
+*/
+static uint8_t *put_varint(uint8_t *p, uint64_t value){
+    while (value >= 0x80){
+        *p++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (uint8_t)value;
+    return p;
+}
+
+/**
+ * Writes the tag of a record of `type` at `time` at `p`, and returns a pointer to the byte after it. Records without
+ * a time of their own pass the time of the last event.
+*/
+static uint8_t *put_tag(trace_t *trace, uint8_t *p, int type, long time){
+    assert(time >= trace->time);
+    uint64_t delta = (uint64_t)(time-trace->time);
+    trace->time = time;
+    return put_varint(p, delta << TRACE_TYPE_BITS | (uint64_t)type);
+}
+
+/**
+ * Marks the bytes of `trace` up to `end` as written.
+*/
+static void commit(trace_t *trace, uint8_t *end){
+    trace->size = end-(uint8_t *)trace->map;
+}
+
+/**
+ * Returns the value of the hexadecimal digit `c`, or 0 if it is not one.
+*/
+static int hex_value(char c){
+    if (c >= '0' && c <= '9'){
+        return c-'0';
+    }
+    if (c >= 'a' && c <= 'f'){
+        return c-'a'+10;
+    }
+    return 0;
+}
+
+/**
+ * Starts a new binary trace in the regular file open on `fd`, and returns a pointer to it. The descriptor may only be
+ * open for writing, as STDOUT is when redirected by a shell, so the file is reopened for reading and writing through
+ * `FD_PATH` and mapped shared. It is truncated, and then sized to `TRACE_INIT_SIZE` bytes, starting with the header.
+*/
+trace_t *new_trace(int fd){
+    struct stat st;
+    if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode)){
+        fprintf(stderr, "Error: a binary trace can only be written to a regular file\n");
+        exit(EXIT_FAILURE);
+    }
+    char path[sizeof(FD_PATH)+16];
+    snprintf(path, sizeof(path), FD_PATH, fd);
+
+    trace_t *trace = (trace_t *)malloc(sizeof(trace_t));
+    assert(trace);
+    trace->fd = open(path, O_RDWR | O_TRUNC | O_CLOEXEC);
+    if (trace->fd == -1 || ftruncate(trace->fd, TRACE_INIT_SIZE) == -1){
+        perror("open");
+        exit(EXIT_FAILURE);
+    }
+    trace->map = (char *)mmap(NULL, TRACE_INIT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, trace->fd, 0);
+    if (trace->map == MAP_FAILED){
+        perror("mmap");
+        exit(EXIT_FAILURE);
+    }
+    trace->size = 0;
+    trace->capacity = TRACE_INIT_SIZE;
+    trace->time = 0;
+
+    trace_header_t header = {.version = TRACE_VERSION};
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    memcpy(reserve(trace, sizeof(header)), &header, sizeof(header));
+    trace->size = sizeof(header);
+    return trace;
+}
+
+/**
+ * Records that the process `id` is called `name`, as the length of the name followed by its bytes.
+*/
+void trace_name(trace_t *trace, proc_id_t id, const char *name){
+    size_t len = strlen(name);
+    uint8_t *p = reserve(trace, 3*TRACE_MAX_VARINT+len);
+    p = put_tag(trace, p, TRACE_NAME, trace->time);
+    p = put_varint(p, id);
+    p = put_varint(p, len);
+    memcpy(p, name, len);
+    commit(trace, p+len);
+}
+
+/**
+ * Records an event of `type` for the process `id` at `time`, with the time since the last event in its tag. Only
+ * RUNNING records its `cpu`.
+*/
+void trace_event(trace_t *trace, int type, long time, proc_id_t id, int cpu, long value){
+    uint8_t *p = reserve(trace, MAX_RECORD);
+    p = put_tag(trace, p, type, time);
+    p = put_varint(p, id);
+    p = put_varint(p, (uint64_t)value);
+    if (type == TRACE_RUNNING){
+        p = put_varint(p, (uint64_t)(cpu+1));
+    }
+    commit(trace, p);
+}
+
+/**
+ * Records that the process `id` has FINISHED-PROCESS at `time`, followed by the hexadecimal `sha` string converted to
+ * `TRACE_SHA_BYTES` raw bytes.
+*/
+void trace_sha(trace_t *trace, long time, proc_id_t id, const char *sha){
+    uint8_t *p = reserve(trace, MAX_RECORD);
+    p = put_tag(trace, p, TRACE_FINISHED_PROCESS, time);
+    p = put_varint(p, id);
+    for (int i = 0; i < TRACE_SHA_BYTES; i++){
+        *p++ = (uint8_t)(hex_value(sha[2*i]) << 4 | hex_value(sha[2*i+1]));
+    }
+    commit(trace, p);
+}
+
+/**
+ * Records the statistic of `type`, for `cpu` if it is UTILISATION, as the bits of the double `value`, so that it can
+ * be printed exactly as it would have been.
+*/
+void trace_stat(trace_t *trace, int type, int cpu, double value){
+    uint8_t *p = reserve(trace, MAX_RECORD);
+    p = put_tag(trace, p, type, trace->time);
+    if (type == TRACE_UTILISATION){
+        p = put_varint(p, (uint64_t)cpu);
+    }
+    memcpy(p, &value, sizeof(value));
+    commit(trace, p+sizeof(value));
+}
+
+/**
+ * Cuts the file of `trace` down to the records written, unmaps it, and frees all memory used by `trace`.
+*/
+void free_trace(trace_t *trace){
+    munmap(trace->map, trace->capacity);
+    if (ftruncate(trace->fd, trace->size) == -1){
+        perror("ftruncate");
+        exit(EXIT_FAILURE);
+    }
+    close(trace->fd);
+    free(trace);
+}
@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include "proc_table.h"
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+// The 8 bytes a binary trace starts with
+#define TRACE_MAGIC "ALLOCTRC"
+// The version of the record layout, bumped whenever it changes
+#define TRACE_VERSION 2
+// The number of bytes a binary trace is first mapped with, doubled whenever it fills up
+#define TRACE_INIT_SIZE (1 << 20)
+// The number of raw bytes of a sha digest after a FINISHED-PROCESS record
+#define TRACE_SHA_BYTES 32
+// The cpu of a RUNNING record when only one CPU is simulated, and the line names none
+#define TRACE_NO_CPU -1
+// The number of low bits of the tag of a record holding its type, above which is the time since the record before
+#define TRACE_TYPE_BITS 4
+// The most bytes a varint can take, for 64 bits in groups of 7
+#define TRACE_MAX_VARINT 10
+
+// Record types. NAME gives the name of the process with an id until the id is reused.
+#define TRACE_NAME 0
+#define TRACE_READY 1
+#define TRACE_RUNNING 2
+#define TRACE_FINISHED 3
+#define TRACE_FINISHED_PROCESS 4
+// Performance statistics, holding the exact doubles that were printed, except for MAKESPAN which holds a long
+#define TRACE_TURNAROUND 5
+#define TRACE_OVERHEAD_MAX 6
+#define TRACE_OVERHEAD_MEAN 7
+#define TRACE_MAKESPAN 8
+#define TRACE_UTILISATION 9
+
+/**
+ * The records of a binary trace are variable-length, with every integer an unsigned LEB128 varint: 7 bits per byte,
+ * least significant first, with the top bit set on every byte but the last. A record starts with its tag, which holds
+ * the type in its low `TRACE_TYPE_BITS` bits and the time since the record before above them, so that an event at the
+ * same time as the one before costs a single byte for both. The rest depends on the type:
+ * - NAME: the process id, the length of the name, and its bytes
+ * - READY, FINISHED, MAKESPAN: the process id, and the address, the number of processes remaining, or the makespan
+ * - RUNNING: the process id, the remaining service time, and the cpu plus one, or 0 for `TRACE_NO_CPU`
+ * - FINISHED-PROCESS: the process id, and the `TRACE_SHA_BYTES` raw bytes of the digest
+ * - TURNAROUND, OVERHEAD_MAX, OVERHEAD_MEAN: the 8 bytes of the double, in host byte order
+ * - UTILISATION: the cpu, and the 8 bytes of the double
+ * A negative value is written as its 64-bit two's complement, and takes the full `TRACE_MAX_VARINT` bytes.
+*/
+
+/**
+ * The header a binary trace starts with: `TRACE_MAGIC` and `TRACE_VERSION`.
+*/
+typedef struct trace_header{
+    char magic[8];
+    uint32_t version;
+    uint32_t unused;
+} trace_header_t;
+
+/**
+ * A binary trace being written to file `fd` through a shared mapping `map` of `capacity` bytes, of which the first
+ * `size` have been written. The file is grown and remapped whenever it is full, and cut down to `size` once the trace
+ * is finished. `time` is the time of the last event, which the tag of the next one is written relative to.
+*/
+typedef struct trace{
+    int fd;
+    char *map;
+    size_t size;
+    size_t capacity;
+    long time;
+} trace_t;
+
+// Starts a new binary trace in the regular file open on `fd`, which is truncated and reopened for reading and writing
+// so that it can be mapped, and returns a pointer to it
+trace_t *new_trace(int fd);
+
+// Records that the process `id` is called `name`
+void trace_name(trace_t *trace, proc_id_t id, const char *name);
+
+// Records an event of `type` for the process `id` at `time`, which may not be before the last, with `cpu` and `value`
+// as described above `trace_header_t`
+void trace_event(trace_t *trace, int type, long time, proc_id_t id, int cpu, long value);
+
+// Records that the process `id` has FINISHED-PROCESS at `time` with the hexadecimal `sha` string, stored as raw bytes
+void trace_sha(trace_t *trace, long time, proc_id_t id, const char *sha);
+
+// Records the statistic of `type`, for `cpu` if it is UTILISATION, as the bits of the double `value`
+void trace_stat(trace_t *trace, int type, int cpu, double value);
+
+// Cuts the file of `trace` down to the records written, unmaps it, and frees all memory used by `trace`
+void free_trace(trace_t *trace);
+
+#endif
@@ -0,0 +1,266 @@
+/**
+ * Implementation of `transcript_t`, a buffered sink for the transcript with an optional writer thread.
+*/
+#define _GNU_SOURCE
+#include <unistd.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include "transcript.h"
+
+// The longest line transcript_printf() formats
+#define PRINTF_LEN 256
+
+// The transcript flushed if the simulation exits before freeing it, as stdio would flush stdout
+static transcript_t *open_transcript = NULL;
+
+/**
+ * Sleeps until `word` is no longer `value`, or a wake-up. May return early, so callers check `word` again.
+*/
+static void futex_wait(_Atomic uint32_t *word, uint32_t value){
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+}
+
+/**
+ * Wakes the other thread of a transcript if it is sleeping on `word`.
+*/
+static void futex_wake(_Atomic uint32_t *word){
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+/**
+ * Writes the bytes of `transcript` from count `from` up to count `to` to its fd, as one writev() of the two pieces
+ * they may wrap around into, repeated until every byte is written.
+*/
+static void write_out(transcript_t *transcript, uint32_t from, uint32_t to){
+    while (from != to){
+        uint32_t start = from & (TRANSCRIPT_SIZE-1);
+        uint32_t n = to-from;
+        struct iovec pieces[2];
+        int n_pieces = 1;
+        pieces[0].iov_base = transcript->buffer+start;
+        pieces[0].iov_len = n;
+        if (start+n > TRANSCRIPT_SIZE){
+            pieces[0].iov_len = TRANSCRIPT_SIZE-start;
+            pieces[1].iov_base = transcript->buffer;
+            pieces[1].iov_len = n-pieces[0].iov_len;
+            n_pieces = 2;
+        }
+        ssize_t written = writev(transcript->fd, pieces, n_pieces);
+        if (written == -1){
+            if (errno == EINTR){
+                continue;
+            }
+            perror("writev");
+            _exit(EXIT_FAILURE);
+        }
+        from += (uint32_t)written;
+    }
+}
+
+/**
+ * Writes bytes of `transcript` on its writer thread as they are committed, sleeping on `wakeups` while there are none,
+ * until it is closing and they have all been written. Publishes each batch written in `head`, waking the simulation in case it is waiting for room or a flush.
+*/
+static void *write_ahead(void *arg){
+    transcript_t *transcript = (transcript_t *)arg;
+    uint32_t head = atomic_load_explicit(&transcript->head, memory_order_relaxed);
+    while (1){
+        // Read `wakeups` first, so that a commit made after checking for bytes stops the futex from sleeping
+        uint32_t wakeups = atomic_load_explicit(&transcript->wakeups, memory_order_acquire);
+        uint32_t committed = atomic_load_explicit(&transcript->committed, memory_order_acquire);
+        if (committed == head){
+            if (atomic_load_explicit(&transcript->closing, memory_order_acquire)){
+                break;
+            }
+            futex_wait(&transcript->wakeups, wakeups);
+            continue;
+        }
+        write_out(transcript, head, committed);
+        head = committed;
+        atomic_store_explicit(&transcript->head, head, memory_order_release);
+        futex_wake(&transcript->head);
+    }
+    return NULL;
+}
+
+/**
+ * Counts a wake-up of the writer thread of `transcript` in `wakeups`, and wakes it if it is sleeping.
+*/
+static void wake_writer(transcript_t *transcript){
+    atomic_fetch_add_explicit(&transcript->wakeups, 1, memory_order_release);
+    futex_wake(&transcript->wakeups);
+}
+
+/**
+ * Hands on every byte formatted into `transcript` to be written. With a writer thread, they are published in 
+ * `committed` and the writer is woken. Otherwise, they are written there and then.
+*/
+static void commit(transcript_t *transcript){
+    if (transcript->async){
+        atomic_store_explicit(&transcript->committed, transcript->tail, memory_order_release);
+        wake_writer(transcript);
+    }
+    else {
+        write_out(transcript, atomic_load_explicit(&transcript->head, memory_order_relaxed), transcript->tail);
+        atomic_store_explicit(&transcript->committed, transcript->tail, memory_order_relaxed);
+        atomic_store_explicit(&transcript->head, transcript->tail, memory_order_relaxed);
+    }
+}
+
+/**
+ * Waits until no more than `pending` bytes of `transcript` are left to be written.
+*/
+static void wait_written(transcript_t *transcript, uint32_t pending){
+    uint32_t head = atomic_load_explicit(&transcript->head, memory_order_acquire);
+    while (transcript->tail-head > pending){
+        futex_wait(&transcript->head, head);
+        head = atomic_load_explicit(&transcript->head, memory_order_acquire);
+    }
+}
+
+/**
+ * Appends `n` `bytes` to `transcript`. Whenever the buffer is full, everything in it is handed on, and the rest waits
+ * for room.
+*/
+static void append(transcript_t *transcript, const char *bytes, size_t n){
+    while (n > 0){
+        uint32_t room = TRANSCRIPT_SIZE-(transcript->tail-atomic_load_explicit(&transcript->head, memory_order_acquire));
+        if (room == 0){
+            commit(transcript);
+            wait_written(transcript, TRANSCRIPT_SIZE-TRANSCRIPT_BATCH);
+            continue;
+        }
+        // Copy up to the end of the buffer at most, wrapping around on the next pass
+        uint32_t start = transcript->tail & (TRANSCRIPT_SIZE-1);
+        size_t chunk = n < room ? n : room;
+        if (chunk > TRANSCRIPT_SIZE-start){
+            chunk = TRANSCRIPT_SIZE-start;
+        }
+        memcpy(transcript->buffer+start, bytes, chunk);
+        transcript->tail += (uint32_t)chunk;
+        bytes += chunk;
+        n -= chunk;
+    }
+}
+
+/**
+ * Flushes the transcript still open when the simulation exits, unless it is exiting from the writer thread itself.
+*/
+static void flush_at_exit(){
+    if (open_transcript != NULL && !(open_transcript->async && pthread_equal(pthread_self(), open_transcript->writer))){
+        transcript_flush(open_transcript);
+    }
+}
+
+/**
+ * Allocates memory for a new, empty transcript writing to `fd`, and returns a pointer to it. If `async`, starts its
+ * writer thread. Lines are handed on one at a time if `fd` is a terminal, so that they show up as they happen.
+*/
+transcript_t *new_transcript(int fd, int async){
+    transcript_t *transcript = (transcript_t *)aligned_alloc(TRANSCRIPT_LINE, sizeof(transcript_t));
+    assert(transcript);
+    transcript->buffer = (char *)malloc(TRANSCRIPT_SIZE);
+    assert(transcript->buffer);
+    atomic_init(&transcript->head, 0);
+    atomic_init(&transcript->committed, 0);
+    atomic_init(&transcript->wakeups, 0);
+    atomic_init(&transcript->closing, 0);
+    transcript->tail = 0;
+    transcript->fd = fd;
+    transcript->interactive = isatty(fd);
+    transcript->async = async;
+    if (async && pthread_create(&transcript->writer, NULL, write_ahead, transcript) != 0){
+        perror("pthread_create");
+        exit(EXIT_FAILURE);
+    }
+
+    if (open_transcript == NULL){
+        static int registered = 0;
+        if (!registered){
+            atexit(flush_at_exit);
+            registered = 1;
+        }
+        open_transcript = transcript;
+    }
+    return transcript;
+}
+
+/**
+ * Appends the null-terminated string `str` to `transcript`.
+*/
+void transcript_str(transcript_t *transcript, const char *str){
+    append(transcript, str, strlen(str));
+}
+
+/**
+ * Appends the decimal digits of `value`, after a minus sign if it is negative, to `transcript`. The digits are 
+ * produced backwards from the least significant into a small buffer, rather than through printf().
+*/
+void transcript_long(transcript_t *transcript, long value){
+    char digits[24];
+    char *p = digits+sizeof(digits);
+    unsigned long magnitude = value < 0 ? -(unsigned long)value : (unsigned long)value;
+    do {
+        *--p = (char)('0'+magnitude%10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0){
+        *--p = '-';
+    }
+    append(transcript, p, digits+sizeof(digits)-p);
+}
+
+/**
+ * Appends `format` with its arguments, as printf() would print them, to `transcript`. Lines longer than `PRINTF_LEN`
+ * are cut short.
+*/
+void transcript_printf(transcript_t *transcript, const char *format, ...){
+    char line[PRINTF_LEN];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (n > 0){
+        append(transcript, line, n < PRINTF_LEN ? n : PRINTF_LEN-1);
+    }
+}
+
+/**
+ * Ends the current line of `transcript` with a newline. Hands on the buffered bytes to be written if at least 
+ * `TRANSCRIPT_BATCH` have built up since the last batch, or if `transcript` is interactive.
+*/
+void transcript_end_line(transcript_t *transcript){
+    append(transcript, "\n", 1);
+    if (transcript->interactive || transcript->tail-atomic_load_explicit(&transcript->committed, memory_order_relaxed) >= TRANSCRIPT_BATCH){
+        commit(transcript);
+    }
+}
+
+/**
+ * Hands on every byte appended to `transcript` so far, and waits until they have been written.
+*/
+void transcript_flush(transcript_t *transcript){
+    commit(transcript);
+    wait_written(transcript, 0);
+}
+
+/**
+ * Flushes `transcript`, then tells its writer thread to exit and waits for it, and frees all memory used by it.
+*/
+void free_transcript(transcript_t *transcript){
+    transcript_flush(transcript);
+    if (transcript->async){
+        atomic_store_explicit(&transcript->closing, 1, memory_order_release);
+        wake_writer(transcript);
+        pthread_join(transcript->writer, NULL);
+    }
+    if (open_transcript == transcript){
+        open_transcript = NULL;
+    }
+    free(transcript->buffer);
+    free(transcript);
+}
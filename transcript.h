@@ -0,0 +1,63 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <assert.h>
+#include <pthread.h>
+
+#ifndef __TRANSCRIPT_H__
+#define __TRANSCRIPT_H__
+
+// The number of bytes a transcript can buffer, a power of two
+#define TRANSCRIPT_SIZE (1 << 20)
+// The number of buffered bytes at which a transcript hands them on to be written at the end of a line
+#define TRANSCRIPT_BATCH (1 << 16)
+// The size of a cache line, which the counters written by either thread are kept apart by
+#define TRANSCRIPT_LINE 64
+
+/**
+ * A sink for the lines of the simulation's transcript, which are formatted straight into the ring `buffer` and 
+ * written to `fd` in batches with writev(). `tail` counts the bytes formatted so far, `committed` the bytes handed on
+ * to be written, and `head` the bytes written. All three count up forever, and are wrapped into `buffer` with a mask.
+ * Bytes are handed on at the end of a line once `TRANSCRIPT_BATCH` have built up, or of every line if `fd` is a 
+ * terminal (`interactive`). If `async`, a `writer` thread writes them while the simulation carries on, sleeping with
+ * a futex on `wakeups`, which counts the times it has been woken, while there are none. Otherwise they are written
+ * there and then. `closing` tells the writer to exit once it has written everything.
+*/
+typedef struct transcript{
+    _Alignas(TRANSCRIPT_LINE) _Atomic uint32_t head;
+    _Alignas(TRANSCRIPT_LINE) _Atomic uint32_t committed;
+    _Atomic uint32_t wakeups;
+    _Atomic int closing;
+    _Alignas(TRANSCRIPT_LINE) uint32_t tail;
+    int fd;
+    int interactive;
+    int async;
+    char *buffer;
+    pthread_t writer;
+} transcript_t;
+
+// Allocates memory for a new, empty transcript writing to `fd`, with a writer thread if `async`, and returns a
+// pointer to it
+transcript_t *new_transcript(int fd, int async);
+
+// Appends the null-terminated string `str` to `transcript`
+void transcript_str(transcript_t *transcript, const char *str);
+
+// Appends the decimal digits of `value` to `transcript`
+void transcript_long(transcript_t *transcript, long value);
+
+// Appends `format` with its arguments, as printf() would print them, to `transcript`. Meant for lines off the hot
+// path, such as the performance statistics.
+void transcript_printf(transcript_t *transcript, const char *format, ...);
+
+// Ends the current line of `transcript`, handing on the buffered bytes to be written if enough have built up
+void transcript_end_line(transcript_t *transcript);
+
+// Writes every byte appended to `transcript` so far, returning once they have been written
+void transcript_flush(transcript_t *transcript);
+
+// Flushes `transcript`, stops its writer thread, and frees all memory used by it
+void free_transcript(transcript_t *transcript);
+
+#endif
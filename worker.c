@@ -0,0 +1,152 @@
+/**
+ * Spawning of real processes, and `worker_pool_t`, a pool of real processes that are reused across simulated 
+ * processes.
+*/
+#define _GNU_SOURCE
+#include "worker.h"
+
+/**
+ * Spawns "process" with `args` and `actions` using posix_spawn(), which does not copy the page tables of this 
+ * process, and returns its process id. `actions` are destroyed.
+*/
+static pid_t spawn(posix_spawn_file_actions_t *actions, char *const args[]){
+    pid_t pid;
+    int error = posix_spawn(&pid, PROCESS_PATH, actions, NULL, args, environ);
+    posix_spawn_file_actions_destroy(actions);
+    if (error != 0){
+        errno = error;
+        perror("posix_spawn");
+        exit(EXIT_FAILURE);
+    }
+    return pid;
+}
+
+/**
+ * Spawns "process" with `args`. Uses pipe2() and spawn file actions to redirect STDIN and STDOUT to and from 
+ * "process". The pipes are close-on-exec, so that each child only keeps its own ends, as dup2() clears the flag. Sets
+ * the `pid`, `fd_1` and `fd_2` of `process`, and closes the read side of `fd_1` and the write side of `fd_2`.
+*/
+void spawn_process(process_t *process, char *const args[]){
+    posix_spawn_file_actions_t actions;
+    
+    /* Creates two pipes. The idea of using two pipes for two-way communication between parent and child process was 
+    referenced from tutorialspoint. Inter Process Communication. 
+    https://www.tutorialspoint.com/inter_process_communication/inter_process_communication_pipes.htm.
+    Accessed on 15/4/2023, and modified to work with process_t struct for this project. */
+    if (pipe2(process->fd_1, O_CLOEXEC) == -1){
+        perror("pipe2");
+        exit(EXIT_FAILURE);
+    }
+    if (pipe2(process->fd_2, O_CLOEXEC) == -1){
+        perror("pipe2");
+        exit(EXIT_FAILURE);
+    }
+
+    // Redirect STDIN and STDOUT to and from "process", every other end of the pipes is closed on exec
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, process->fd_1[0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, process->fd_2[1], STDOUT_FILENO);
+
+    // Create child process
+    process->pid = spawn(&actions, args);
+
+    // Close the read side of `fd_1`, and the write side of `fd_2`
+    close(process->fd_1[0]);
+    close(process->fd_2[1]);
+}
+
+/**
+ * Spawns "process" with `args`, with a new channel in place of pipes. The memfd of the channel becomes the STDIN of
+ * "process", which maps it too, and is then closed here, as the mapping stays. Sets the `pid` and `channel` of 
+ * `process`.
+*/
+void spawn_channel_process(process_t *process, char *const args[]){
+    posix_spawn_file_actions_t actions;
+    int fd;
+
+    process->channel = new_channel(&fd);
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fd, STDIN_FILENO);
+    process->pid = spawn(&actions, args);
+    close(fd);
+}
+
+/**
+ * Dynamically reallocates the idle workers of `pool` if they are full, so that there is room for one more.
+*/
+static void make_room(worker_pool_t *pool){
+    if (pool->size == pool->capacity){
+        pool->capacity = pool->capacity > 0 ? pool->capacity*POOL_REALLOC_SCALE : 1;
+        pool->idle = (process_t *)realloc(pool->idle, sizeof(process_t)*pool->capacity);
+        assert(pool->idle);
+    }
+}
+
+/**
+ * Spawns a worker, which waits for a process name on STDIN, onto the idle workers of `pool`.
+*/
+static void spawn_worker(worker_pool_t *pool){
+    char *args[] = {PROCESS_PATH, POOL_OPTION, NULL};
+    make_room(pool);
+    spawn_process(&pool->idle[pool->size++], args);
+}
+
+/**
+ * Allocates memory for a new worker pool `pool`, spawns `n_workers` idle workers in it up front, and returns a 
+ * pointer to it. More workers are spawned later if they are all in use.
+*/
+worker_pool_t *new_worker_pool(int n_workers){
+    worker_pool_t *pool = (worker_pool_t *)malloc(sizeof(worker_pool_t));
+    assert(pool);
+    pool->capacity = 0;
+    pool->size = 0;
+    pool->idle = NULL;
+    for (int i = 0; i < n_workers; i++){
+        spawn_worker(pool);
+    }
+    return pool;
+}
+
+/**
+ * Takes the most recently idle worker of `pool` for `process`, spawning one if there are none, and gives `process` its
+ * `pid` and pipes. The worker is sent the name of `process` as a length byte followed by the name, after which it 
+ * takes the same messages as a process started with that name.
+*/
+void assign_worker(worker_pool_t *pool, process_t *process){
+    uint8_t message[1+MAX_NAME_LEN];
+    if (pool->size == 0){
+        spawn_worker(pool);
+    }
+    process_t *worker = &pool->idle[--pool->size];
+    process->pid = worker->pid;
+    memcpy(process->fd_1, worker->fd_1, sizeof(process->fd_1));
+    memcpy(process->fd_2, worker->fd_2, sizeof(process->fd_2));
+
+    size_t name_len = strlen(process->name);
+    message[0] = (uint8_t)name_len;
+    memcpy(message+1, process->name, name_len);
+    write(process->fd_1[1], message, 1+name_len);
+}
+
+/**
+ * Returns the worker of `process` to the idle workers of `pool`. The worker has printed the sha of `process`, and 
+ * has reset its hash to wait for a new name.
+*/
+void release_worker(worker_pool_t *pool, process_t *process){
+    make_room(pool);
+    pool->idle[pool->size++] = *process;
+}
+
+/**
+ * Closes the pipes of every idle worker of `pool`. Each worker exits when it reads the end of its STDIN instead of a 
+ * name, and is waited for. Then frees all memory used by `pool`.
+*/
+void free_worker_pool(worker_pool_t *pool){
+    for (int i = 0; i < pool->size; i++){
+        close(pool->idle[i].fd_1[1]);
+        close(pool->idle[i].fd_2[0]);
+        waitpid(pool->idle[i].pid, NULL, 0);
+    }
+    free(pool->idle);
+    free(pool);
+}
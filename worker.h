@@ -0,0 +1,55 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include "proc_table.h"
+#include "channel.h"
+
+#ifndef __WORKER_H__
+#define __WORKER_H__
+
+// The executable run by every real process
+#define PROCESS_PATH "process"
+// The option that starts "process" as a pooled worker, which is sent each process name on STDIN
+#define POOL_OPTION "--pool"
+// The scale by which the idle workers of a pool are dynamically reallocated
+#define POOL_REALLOC_SCALE 2
+
+/**
+ * A pool of pre-spawned "process" workers, which are reused from one simulated process to the next instead of being
+ * spawned and reaped for each. The `size` workers in `idle` are waiting to be sent a process name, and `idle` has room
+ * for `capacity` workers. Only the `pid`, `fd_1` and `fd_2` of each idle worker are used.
+*/
+typedef struct worker_pool{
+    int capacity;
+    int size;
+    process_t *idle;
+} worker_pool_t;
+
+// Spawns "process" with `args`, with its STDIN and STDOUT redirected to and from pipes, and sets the `pid`, `fd_1` and
+// `fd_2` of `process`. Only the parent's ends of the pipes are left open.
+void spawn_process(process_t *process, char *const args[]);
+
+// Spawns "process" with `args`, with a new channel mapped from its STDIN, and sets the `pid` and `channel` of `process`
+void spawn_channel_process(process_t *process, char *const args[]);
+
+// Allocates memory for a new worker pool, spawns `n_workers` idle workers in it, and returns a pointer to it
+worker_pool_t *new_worker_pool(int n_workers);
+
+// Takes an idle worker from `pool` for `process`, spawning one if there are none, and sends it the name of `process`
+void assign_worker(worker_pool_t *pool, process_t *process);
+
+// Returns the worker of `process`, which has printed its sha and is waiting for a new name, to the idle workers of 
+// `pool`
+void release_worker(worker_pool_t *pool, process_t *process);
+
+// Closes the pipes of every idle worker of `pool`, which then exit, waits for them, and frees all memory used by `pool`
+void free_worker_pool(worker_pool_t *pool);
+
+#endif
@@ -0,0 +1,514 @@
+/**
+ * Implementation of `workload_t`. A regular input file is mapped into memory and parsed once, up front, with a 
+ * hand-written parser, so that arrivals are handed out with a cursor rather than re-read every cycle. Standard input
+ * and pipes are streamed in blocks with a lookahead of one process, and are never rewound. Streaming can also run on
+ * its own thread, parsing ahead of the simulation. A binary workload, written by "convert_workload", is mapped and its
+ * columns are used in place, with nothing to parse.
+*/
+#include "workload.h"
+
+static int is_binary(int fd, size_t bytes);
+static void map_binary(workload_t *workload, int fd, size_t bytes);
+static void map_workload(workload_t *workload, int fd, size_t bytes);
+static void stream_next(workload_t *workload);
+static void *parse_ahead(void *arg);
+static const char *parse_line(const char *p, const char *end, arrival_t *arrival, int *found, long line_no);
+
+/**
+ * Reads the processes of the input file `filename`, or of standard input if `filename` is `STDIN_NAME`, and returns a
+ * pointer to the workload. Each line holds the arrival time, name, service time and memory requirement of a process,
+ * separated by whitespace. Blank lines are skipped, and malformed lines are reported as errors.
+ * A regular file is mapped into memory and parsed once. Anything else, such as a pipe, is streamed through a buffer of
+ * `STREAM_BLOCK` bytes, so memory use stays the same however long the input is. A regular file starting with 
+ * `WORKLOAD_MAGIC` is a binary workload instead, which is mapped and used as it is, however it is loaded.
+ * If `pipelined` is set, any text input is streamed by a parser thread instead, which runs up to `PIPELINE_DEPTH` 
+ * processes ahead of the simulation. Processes are still handed out in input order, so the simulation is unchanged.
+*/
+workload_t *load_workload(const char *filename, int pipelined){
+    workload_t *workload = (workload_t *)malloc(sizeof(workload_t));
+    assert(workload);
+    workload->capacity = 0;
+    workload->n_processes = 0;
+    workload->cursor = 0;
+    workload->time_arr = NULL;
+    workload->names = NULL;
+    workload->serv_time = NULL;
+    workload->mem_req = NULL;
+    workload->map = NULL;
+    workload->map_bytes = 0;
+    workload->name_id = NULL;
+    workload->n_names = 0;
+    workload->name_offset = NULL;
+    workload->strings = NULL;
+    workload->buffer = NULL;
+    workload->start = 0;
+    workload->end = 0;
+    workload->eof = 0;
+    workload->line_no = 0;
+    workload->has_next = 0;
+    workload->slots = NULL;
+    workload->current = NO_PROC;
+
+    int fd = STDIN_FILENO;
+    if (strcmp(filename, STDIN_NAME) != 0){
+        fd = open(filename, O_RDONLY);
+        if (fd == -1){
+            perror("open");
+            exit(EXIT_FAILURE);
+        }
+    }
+    workload->fd = fd;
+
+    struct stat st;
+    if (fstat(fd, &st) == -1){
+        perror("fstat");
+        exit(EXIT_FAILURE);
+    }
+    if (S_ISREG(st.st_mode) && is_binary(fd, st.st_size)){
+        map_binary(workload, fd, st.st_size);
+        if (fd != STDIN_FILENO){
+            close(fd);
+        }
+        workload->fd = -1;
+    }
+    else if (pipelined){
+        workload->buffer = (char *)malloc(STREAM_BLOCK);
+        workload->slots = (arrival_t *)malloc(sizeof(arrival_t)*PIPELINE_DEPTH);
+        assert(workload->buffer && workload->slots);
+        // `parsed` also has room for `END_SLOT`, so the parser never waits to push a slot it has filled
+        workload->parsed = new_spsc_ring(PIPELINE_DEPTH+1);
+        workload->free_slots = new_spsc_ring(PIPELINE_DEPTH);
+        for (proc_id_t slot = 0; slot < PIPELINE_DEPTH; slot++){
+            spsc_push(workload->free_slots, slot);
+        }
+        if (pthread_create(&workload->parser, NULL, parse_ahead, workload) != 0){
+            perror("pthread_create");
+            exit(EXIT_FAILURE);
+        }
+    }
+    else if (S_ISREG(st.st_mode)){
+        map_workload(workload, fd, st.st_size);
+        if (fd != STDIN_FILENO){
+            close(fd);
+        }
+        workload->fd = -1;
+    }
+    else {
+        workload->buffer = (char *)malloc(STREAM_BLOCK);
+        assert(workload->buffer);
+        stream_next(workload);
+    }
+    return workload;
+}
+
+/**
+ * Returns the arrival time of the next process in `workload` without consuming it, or `NO_ARRIVAL` if every process
+ * has arrived.
+*/
+long peek_arrival(workload_t *workload){
+    if (workload->slots != NULL){
+        if (workload->current == NO_PROC){
+            workload->current = spsc_pop_wait(workload->parsed);
+        }
+        if (workload->current == END_SLOT){
+            return NO_ARRIVAL;
+        }
+        return workload->slots[workload->current].time_arr;
+    }
+    if (workload->buffer != NULL){
+        if (!workload->has_next){
+            return NO_ARRIVAL;
+        }
+        return workload->next.time_arr;
+    }
+    if (workload->cursor == workload->n_processes){
+        return NO_ARRIVAL;
+    }
+    return workload->time_arr[workload->cursor];
+}
+
+/**
+ * Fills in the arrival time, name, service time and memory requirement of process `id` of `table` from the next 
+ * process in `workload`, and moves on to the one after it. The remaining service time starts at the service time.
+*/
+void read_arrival(workload_t *workload, proc_table_t *table, proc_id_t id){
+    if (workload->slots != NULL){
+        peek_arrival(workload);
+        arrival_t *arrival = &workload->slots[workload->current];
+        table->time_arr[id] = arrival->time_arr;
+        memcpy(table->processes[id].name, arrival->name, MAX_NAME_LEN);
+        table->serv_time[id] = arrival->serv_time;
+        table->serv_time_remaining[id] = arrival->serv_time;
+        table->mem_req[id] = arrival->mem_req;
+        spsc_push_wake(workload->free_slots, workload->current);
+        workload->current = NO_PROC;
+        return;
+    }
+    if (workload->buffer != NULL){
+        table->time_arr[id] = workload->next.time_arr;
+        memcpy(table->processes[id].name, workload->next.name, MAX_NAME_LEN);
+        table->serv_time[id] = workload->next.serv_time;
+        table->serv_time_remaining[id] = workload->next.serv_time;
+        table->mem_req[id] = workload->next.mem_req;
+        stream_next(workload);
+        return;
+    }
+
+    long i = workload->cursor++;
+    table->time_arr[id] = workload->time_arr[i];
+    if (workload->map != NULL){
+        // Processes are checked as they arrive, as the text parser would have, so that loading touches nothing
+        uint32_t name = workload->name_id[i];
+        uint64_t string_bytes = (const char *)workload->map + workload->map_bytes - workload->strings;
+        if (name >= workload->n_names || workload->name_offset[name] >= workload->name_offset[name+1] 
+            || workload->name_offset[name+1] > string_bytes 
+            || workload->name_offset[name+1]-workload->name_offset[name] >= MAX_NAME_LEN
+            || workload->serv_time[i] < 0 || workload->mem_req[i] < 0){
+            fprintf(stderr, "Error: malformed process %ld of binary workload\n", i+1);
+            exit(EXIT_FAILURE);
+        }
+        memset(table->processes[id].name, 0, MAX_NAME_LEN);
+        memcpy(table->processes[id].name, workload->strings+workload->name_offset[name], workload->name_offset[name+1]-workload->name_offset[name]);
+    }
+    else {
+        memcpy(table->processes[id].name, workload->names[i], MAX_NAME_LEN);
+    }
+    table->serv_time[id] = workload->serv_time[i];
+    table->serv_time_remaining[id] = workload->serv_time[i];
+    table->mem_req[id] = workload->mem_req[i];
+}
+
+// Returns 1 if every process in `workload` has arrived, and 0 otherwise.
+int workload_done(workload_t *workload){
+    if (workload->slots != NULL){
+        return peek_arrival(workload) == NO_ARRIVAL;
+    }
+    if (workload->buffer != NULL){
+        return !workload->has_next;
+    }
+    return workload->cursor == workload->n_processes;
+}
+
+// Frees all memory used by `workload`, and closes the input file if it is still open. A parser thread is waited for
+// first, which has finished once every process has arrived.
+void free_workload(workload_t *workload){
+    if (workload->slots != NULL){
+        pthread_join(workload->parser, NULL);
+        free_spsc_ring(workload->parsed);
+        free_spsc_ring(workload->free_slots);
+        free(workload->slots);
+    }
+    if (workload->buffer != NULL){
+        free(workload->buffer);
+        if (workload->fd != STDIN_FILENO){
+            close(workload->fd);
+        }
+    }
+    else if (workload->map != NULL){
+        munmap(workload->map, workload->map_bytes);
+    }
+    else {
+        free_region(workload->time_arr, sizeof(unsigned int)*workload->capacity);
+        free_region(workload->names, MAX_NAME_LEN*workload->capacity);
+        free_region(workload->serv_time, sizeof(long)*workload->capacity);
+        free_region(workload->mem_req, sizeof(int)*workload->capacity);
+    }
+    free(workload);
+}
+
+/**
+ * Returns `offset` rounded up to a multiple of `WORKLOAD_ALIGN`.
+*/
+static size_t align(size_t offset){
+    return (offset+WORKLOAD_ALIGN-1) / WORKLOAD_ALIGN * WORKLOAD_ALIGN;
+}
+
+/**
+ * Fills in `layout` with where each column of a binary workload with the counts in `header` starts, one after the 
+ * other, each aligned to `WORKLOAD_ALIGN` bytes, and with the size of the whole file.
+*/
+void workload_layout(const workload_header_t *header, workload_layout_t *layout){
+    layout->time_arr = align(sizeof(workload_header_t));
+    layout->serv_time = align(layout->time_arr + sizeof(uint32_t)*header->n_processes);
+    layout->mem_req = align(layout->serv_time + sizeof(int64_t)*header->n_processes);
+    layout->name_id = align(layout->mem_req + sizeof(int32_t)*header->n_processes);
+    layout->name_offset = align(layout->name_id + sizeof(uint32_t)*header->n_processes);
+    layout->strings = layout->name_offset + sizeof(uint64_t)*(header->n_names+1);
+    layout->bytes = layout->strings + header->string_bytes;
+}
+
+/**
+ * Returns 1 if the regular file `fd` of `bytes` bytes starts with `WORKLOAD_MAGIC`, and 0 otherwise. The file is read
+ * with pread(), so nothing is consumed.
+*/
+static int is_binary(int fd, size_t bytes){
+    char magic[sizeof(((workload_header_t *)0)->magic)];
+    if (bytes < sizeof(workload_header_t)){
+        return 0;
+    }
+    return pread(fd, magic, sizeof(magic), 0) == sizeof(magic) && memcmp(magic, WORKLOAD_MAGIC, sizeof(magic)) == 0;
+}
+
+/**
+ * Maps the binary workload of `bytes` bytes in the regular file `fd`, and points the columns of `workload` into the
+ * mapping. Only the header is checked here, against the size of the file, so no other page is touched until the
+ * processes arrive. The mapping is private and read-only, and is read front to back.
+*/
+static void map_binary(workload_t *workload, int fd, size_t bytes){
+    char *data = mmap(NULL, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED){
+        perror("mmap");
+        exit(EXIT_FAILURE);
+    }
+    madvise(data, bytes, MADV_SEQUENTIAL);
+
+    workload_header_t header;
+    workload_layout_t layout;
+    memcpy(&header, data, sizeof(header));
+    // Counts larger than the file are rejected first, so that the layout cannot overflow
+    if (header.version != WORKLOAD_VERSION || header.n_processes > bytes || header.n_names >= bytes 
+        || header.string_bytes > bytes){
+        fprintf(stderr, "Error: malformed binary workload\n");
+        exit(EXIT_FAILURE);
+    }
+    workload_layout(&header, &layout);
+    if (layout.bytes > bytes){
+        fprintf(stderr, "Error: malformed binary workload\n");
+        exit(EXIT_FAILURE);
+    }
+
+    workload->map = data;
+    workload->map_bytes = bytes;
+    workload->n_processes = header.n_processes;
+    workload->time_arr = (unsigned int *)(data+layout.time_arr);
+    workload->serv_time = (long *)(data+layout.serv_time);
+    workload->mem_req = (int *)(data+layout.mem_req);
+    workload->name_id = (uint32_t *)(data+layout.name_id);
+    workload->n_names = header.n_names;
+    workload->name_offset = (uint64_t *)(data+layout.name_offset);
+    workload->strings = data+layout.strings;
+}
+
+/**
+ * Maps `bytes` bytes of the regular file `fd` into memory and parses every line of it into the columns of `workload`.
+ * The columns are sized by counting the lines first, so parsing does not need to grow them.
+*/
+static void map_workload(workload_t *workload, int fd, size_t bytes){
+    const char *data = NULL;
+    const char *end = NULL;
+    if (bytes > 0){
+        data = mmap(NULL, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED){
+            perror("mmap");
+            exit(EXIT_FAILURE);
+        }
+        madvise((void *)data, bytes, MADV_SEQUENTIAL);
+        end = data + bytes;
+
+        // Count the lines, including a final line without a newline, to size the columns
+        for (const char *p = data; p < end && (p = memchr(p, '\n', end-p)) != NULL; p++){
+            workload->capacity++;
+        }
+        if (end[-1] != '\n'){
+            workload->capacity++;
+        }
+    }
+
+    workload->time_arr = (unsigned int *)new_region(sizeof(unsigned int)*workload->capacity);
+    workload->names = (char (*)[MAX_NAME_LEN])new_region(MAX_NAME_LEN*workload->capacity);
+    workload->serv_time = (long *)new_region(sizeof(long)*workload->capacity);
+    workload->mem_req = (int *)new_region(sizeof(int)*workload->capacity);
+
+    const char *p = data;
+    arrival_t arrival;
+    int found;
+    while (p < end){
+        p = parse_line(p, end, &arrival, &found, ++workload->line_no);
+        if (found){
+            long i = workload->n_processes++;
+            workload->time_arr[i] = arrival.time_arr;
+            memcpy(workload->names[i], arrival.name, MAX_NAME_LEN);
+            workload->serv_time[i] = arrival.serv_time;
+            workload->mem_req[i] = arrival.mem_req;
+        }
+    }
+
+    if (data != NULL){
+        munmap((void *)data, bytes);
+    }
+}
+
+/**
+ * Reads more of the streamed input into the buffer of `workload`, after moving any bytes not yet parsed to the front
+ * of it. Sets `eof` once there is nothing left to read.
+*/
+static void fill_buffer(workload_t *workload){
+    int unparsed = workload->end - workload->start;
+    memmove(workload->buffer, workload->buffer + workload->start, unparsed);
+    workload->start = 0;
+    workload->end = unparsed;
+
+    ssize_t n_read;
+    do {
+        n_read = read(workload->fd, workload->buffer + workload->end, STREAM_BLOCK - workload->end);
+    }
+    while (n_read == -1 && errno == EINTR);
+    if (n_read == -1){
+        perror("read");
+        exit(EXIT_FAILURE);
+    }
+    if (n_read == 0){
+        workload->eof = 1;
+    }
+    workload->end += n_read;
+}
+
+/**
+ * Parses the next process of the streamed input into the lookahead `next` of `workload`, reading more of the input
+ * whenever the buffer does not hold a whole line. Clears `has_next` once the input is exhausted.
+*/
+static void stream_next(workload_t *workload){
+    int found = 0;
+    while (!found){
+        const char *p = workload->buffer + workload->start;
+        const char *end = workload->buffer + workload->end;
+        const char *newline = memchr(p, '\n', end-p);
+
+        // The last line of the input may not end in a newline
+        if (newline == NULL && workload->eof){
+            if (p == end){
+                workload->has_next = 0;
+                return;
+            }
+            newline = end-1;
+        }
+
+        if (newline == NULL){
+            if (workload->start == 0 && workload->end == STREAM_BLOCK){
+                fprintf(stderr, "Error: malformed input on line %ld\n", workload->line_no+1);
+                exit(EXIT_FAILURE);
+            }
+            fill_buffer(workload);
+            continue;
+        }
+        parse_line(p, newline+1, &workload->next, &found, ++workload->line_no);
+        workload->start = newline+1 - workload->buffer;
+    }
+    workload->has_next = 1;
+}
+
+/**
+ * Runs the parser thread of a pipelined `workload`. Each process streamed from the input is parsed into a free slot,
+ * waiting for the simulation to hand one back if they are all in use, and the slot is then passed on through 
+ * `parsed`. `END_SLOT` is passed on after the last process.
+*/
+static void *parse_ahead(void *arg){
+    workload_t *workload = (workload_t *)arg;
+
+    stream_next(workload);
+    while (workload->has_next){
+        proc_id_t slot = spsc_pop_wait(workload->free_slots);
+        workload->slots[slot] = workload->next;
+        spsc_push_wake(workload->parsed, slot);
+        stream_next(workload);
+    }
+    spsc_push_wake(workload->parsed, END_SLOT);
+    return NULL;
+}
+
+/**
+ * Reports a malformed line `line_no` of the input file and exits.
+*/
+static void malformed(long line_no){
+    fprintf(stderr, "Error: malformed input on line %ld\n", line_no);
+    exit(EXIT_FAILURE);
+}
+
+// Returns 1 if `c` separates fields on a line, and 0 otherwise
+static int is_blank(char c){
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/**
+ * Parses an unsigned decimal number starting at `*p` into `value`, advancing `*p` past it. Returns 0 if there are no
+ * digits at `*p`, or if the number does not fit in `max`.
+*/
+static int parse_number(const char **p, const char *end, unsigned long max, unsigned long *value){
+    const char *q = *p;
+    unsigned long n = 0;
+    while (q < end && *q >= '0' && *q <= '9'){
+        // Checked before accumulating, as `n` could otherwise wrap around past `max`
+        unsigned long d = *q-'0';
+        if (n > (max-d)/10){
+            return 0;
+        }
+        n = n*10 + d;
+        q++;
+    }
+    if (q == *p){
+        return 0;
+    }
+    *value = n;
+    *p = q;
+    return 1;
+}
+
+/**
+ * Parses the line `line_no` starting at `p` into the arrival time, name, service time and memory requirement of 
+ * `arrival`, and returns a pointer to the start of the next line. `found` is set to 0 for a line with nothing but
+ * whitespace, which is skipped, and to 1 otherwise.
+*/
+static const char *parse_line(const char *p, const char *end, arrival_t *arrival, int *found, long line_no){
+    unsigned long time_arr, serv_time, mem_req;
+
+    *found = 0;
+    while (p < end && is_blank(*p)){
+        p++;
+    }
+    if (p == end || *p == '\n'){
+        return p+1;
+    }
+
+    if (!parse_number(&p, end, UINT_MAX, &time_arr)){
+        malformed(line_no);
+    }
+    while (p < end && is_blank(*p)){
+        p++;
+    }
+
+    // The name runs up to the next whitespace, and must fit in `MAX_NAME_LEN` with its terminator
+    const char *name = p;
+    while (p < end && !is_blank(*p) && *p != '\n'){
+        p++;
+    }
+    if (p == name || p-name >= MAX_NAME_LEN){
+        malformed(line_no);
+    }
+    memset(arrival->name, 0, MAX_NAME_LEN);
+    memcpy(arrival->name, name, p-name);
+
+    while (p < end && is_blank(*p)){
+        p++;
+    }
+    if (!parse_number(&p, end, LONG_MAX, &serv_time)){
+        malformed(line_no);
+    }
+    while (p < end && is_blank(*p)){
+        p++;
+    }
+    if (!parse_number(&p, end, INT_MAX, &mem_req)){
+        malformed(line_no);
+    }
+    while (p < end && is_blank(*p)){
+        p++;
+    }
+    if (p < end && *p != '\n'){
+        malformed(line_no);
+    }
+
+    arrival->time_arr = time_arr;
+    arrival->serv_time = serv_time;
+    arrival->mem_req = mem_req;
+    *found = 1;
+    return p+1;
+}
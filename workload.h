@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <limits.h>
+#include <errno.h>
+#include <sched.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "proc_table.h"
+#include "region.h"
+#include "ring.h"
+
+#ifndef __WORKLOAD_H__
+#define __WORKLOAD_H__
+
+// Returned by peek_arrival() when there are no more processes in the workload
+#define NO_ARRIVAL -1
+// The input file name that selects standard input
+#define STDIN_NAME "-"
+// The number of bytes read at a time when streaming the input, which also bounds the length of a line
+#define STREAM_BLOCK (1 << 16)
+// The number of processes the parser thread can parse ahead of the simulation when pipelined
+#define PIPELINE_DEPTH 4096
+// Sent by the parser thread after the last process, as a slot that does not exist
+#define END_SLOT PIPELINE_DEPTH
+// The 8 bytes a binary workload starts with
+#define WORKLOAD_MAGIC "ALLOCWKL"
+// The version of the binary workload layout, bumped whenever it changes
+#define WORKLOAD_VERSION 1
+// The alignment of each column of a binary workload
+#define WORKLOAD_ALIGN 8
+
+/**
+ * A process as it appears on a line of the input file, before it has arrived.
+*/
+typedef struct arrival{
+    unsigned int time_arr;
+    char name[MAX_NAME_LEN];
+    long serv_time;
+    int mem_req;
+} arrival_t;
+
+/**
+ * The header of a binary workload, a file holding the processes of an input file as columns, in order of arrival.
+ * After the header come `n_processes` arrival times (uint32_t), service times (int64_t), memory requirements 
+ * (int32_t), and name ids (uint32_t), followed by the interned name table: `n_names`+1 offsets (uint64_t) into 
+ * `string_bytes` bytes of names, name `i` running from offset `i` up to offset `i+1`, without a terminator. Each 
+ * column starts on a multiple of `WORKLOAD_ALIGN` bytes, and everything is in host byte order.
+*/
+typedef struct workload_header{
+    char magic[8];
+    uint32_t version;
+    uint32_t unused;
+    uint64_t n_processes;
+    uint64_t n_names;
+    uint64_t string_bytes;
+} workload_header_t;
+
+/**
+ * Where each column of a binary workload starts, in bytes from the start of the file, and the total `bytes` of the
+ * file.
+*/
+typedef struct workload_layout{
+    size_t time_arr;
+    size_t serv_time;
+    size_t mem_req;
+    size_t name_id;
+    size_t name_offset;
+    size_t strings;
+    size_t bytes;
+} workload_layout_t;
+
+/**
+ * The processes of an input file, in order of arrival. A regular file is parsed once into columns indexed by line:
+ * `n_processes` is the number of processes, and `cursor` is the index of the next process to arrive. `time_arr`, 
+ * `names`, `serv_time` and `mem_req` hold the fields of each process, and `capacity` is the number of processes each
+ * column has room for.
+ * A binary workload is mapped at `map`, of `map_bytes` bytes, and its columns are used where they lie: `time_arr`,
+ * `serv_time` and `mem_req` point into the mapping, and the name of each process is found through `name_id`, 
+ * `name_offset` and `strings` rather than `names`. `map` is NULL for a text input file.
+ * Standard input and pipes are streamed instead, since they cannot be mapped or rewound. `buffer` holds the bytes from
+ * `start` to `end` that have been read from `fd` but not yet parsed, and `next` is a lookahead of the one process that
+ * has been parsed but has not yet arrived, if `has_next` is set. `eof` is set once `fd` has been read to the end, and
+ * `line_no` counts the lines parsed so far. `buffer` is NULL for a regular file.
+ * When pipelined, the input is streamed by a separate `parser` thread, which parses ahead into `slots` and passes the
+ * index of each filled slot to the simulation through the `parsed` ring, in order, followed by `END_SLOT`. The 
+ * simulation hands slots back through the `free_slots` ring once it has read them. `current` is the slot of the next
+ * process to arrive, or `NO_PROC` if it has not been taken from `parsed` yet. `slots` is NULL when not pipelined, and
+ * the streaming fields then belong to the parser thread alone.
+*/
+typedef struct workload{
+    long capacity;
+    long n_processes;
+    long cursor;
+    unsigned int *time_arr;
+    char (*names)[MAX_NAME_LEN];
+    long *serv_time;
+    int *mem_req;
+    void *map;
+    size_t map_bytes;
+    uint32_t *name_id;
+    uint64_t n_names;
+    uint64_t *name_offset;
+    const char *strings;
+    int fd;
+    char *buffer;
+    int start;
+    int end;
+    int eof;
+    long line_no;
+    int has_next;
+    arrival_t next;
+    arrival_t *slots;
+    spsc_ring_t *parsed;
+    spsc_ring_t *free_slots;
+    proc_id_t current;
+    pthread_t parser;
+} workload_t;
+
+// Reads the processes of the input file `filename`, or of standard input if it is `STDIN_NAME`, returning a pointer to
+// the workload. A binary workload is mapped and used as it is. Other regular files are mapped into memory and parsed
+// once, and anything else is streamed. If `pipelined` is set, text input is instead streamed and parsed ahead on a 
+// separate thread.
+workload_t *load_workload(const char *filename, int pipelined);
+
+// Fills in `layout` with where each column of a binary workload with the counts in `header` starts
+void workload_layout(const workload_header_t *header, workload_layout_t *layout);
+
+// Returns the arrival time of the next process in `workload` without consuming it, or `NO_ARRIVAL` if there is none
+long peek_arrival(workload_t *workload);
+
+// Fills in the fields of process `id` of `table` from the next process in `workload`, and moves on to the one after it
+void read_arrival(workload_t *workload, proc_table_t *table, proc_id_t id);
+
+// Returns 1 if every process in `workload` has arrived, and 0 otherwise
+int workload_done(workload_t *workload);
+
+// Frees all memory used by `workload`
+void free_workload(workload_t *workload);
+
+#endif